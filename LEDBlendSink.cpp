@@ -0,0 +1,58 @@
+// NAME: LEDBlendSink.cpp
+//
+// DESC: LEDPixelSink blending the pixels written into it with the pixels already in another
+//       LEDPixelSink, see BlendMode.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDBlendSink.h"
+
+LEDBlendSink::LEDBlendSink(LEDPixelSink &target, const BlendMode mode)
+             :target(target) {
+  this->mode = mode;
+}
+
+uint32_t LEDBlendSink::blend(const BlendMode mode, const uint32_t below, const uint32_t color) {
+  uint32_t result = 0L;
+  switch (mode) {
+    case BlendReplace:
+      return color;
+    case BlendAdd:
+      for (uint8_t shift=0; shift<24; shift+=8) {
+        uint16_t sum = ((below >> shift) & 0xff) + ((color >> shift) & 0xff);
+        result |= (uint32_t)((sum > 255) ? 255 : sum) << shift;
+      }
+      return result;
+    case BlendMax:
+      for (uint8_t shift=0; shift<24; shift+=8) {
+        uint8_t a = (below >> shift) & 0xff;
+        uint8_t b = (color >> shift) & 0xff;
+        result |= (uint32_t)((a > b) ? a : b) << shift;
+      }
+      return result;
+  }
+  return color;
+}
+
+uint32_t LEDBlendSink::mix(const uint32_t below, const uint32_t color, const uint8_t weight) {
+  uint32_t result = 0L;
+  for (uint8_t shift=0; shift<24; shift+=8) {
+    uint16_t a = (below >> shift) & 0xff;
+    uint16_t b = (color >> shift) & 0xff;
+    result |= (uint32_t)((a * (255 - weight) + b * weight + 127) / 255) << shift;
+  }
+  return result;
+}
+
+void LEDBlendSink::setPixelColor(const uint16_t pixelNo, const uint32_t color) {
+  target.setPixelColor(pixelNo, blend(mode, target.getPixelColor(pixelNo), color));
+}
+
+void LEDBlendSink::fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count) {
+  if (target.blendFill(mode, color, firstPixel, count)) return; // target blends the whole span at once
+  uint16_t endPixel = ((uint32_t)firstPixel + count > numPixels()) ? numPixels() : firstPixel + count;
+  for (uint16_t pixelNo=firstPixel; pixelNo<endPixel; pixelNo++) {
+    setPixelColor(pixelNo, color);
+  }
+}
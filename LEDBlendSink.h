@@ -0,0 +1,50 @@
+// NAME: LEDBlendSink.h
+//
+// DESC: LEDPixelSink blending the pixels written into it with the pixels already in another
+//       LEDPixelSink, see BlendMode. Used by LEDClusterController to compose clusters, which
+//       do not simply replace the pixels below.
+//
+//       The pixels below are read back with getPixelColor(). This is exact for
+//       LEDDoubleBufferSink and LEDFrameBufferSink, but approximate for the Adafruit
+//       libraries, if the brightness is below 255.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDBLENDSINK_H
+#define LEDBLENDSINK_H
+
+#include <Arduino.h>
+#include "LEDPixelSink.h"
+#include "LEDCluster.h"
+
+class LEDBlendSink : public LEDPixelSink {
+private:
+  LEDPixelSink  &target;
+  BlendMode     mode;
+
+public:
+  LEDBlendSink(LEDPixelSink &target, const BlendMode mode);
+
+  static uint32_t blend(const BlendMode mode, const uint32_t below, const uint32_t color);
+  static uint32_t mix(const uint32_t below, const uint32_t color, const uint8_t weight); // weight 255 is color only
+
+  virtual void begin()    { target.begin(); }
+  virtual void show()     { target.show(); }
+  virtual bool canShow()  { return target.canShow(); }
+  virtual bool isBusy()   { return target.isBusy(); }
+  virtual bool needsRefresh() { return target.needsRefresh(); }
+
+  virtual uint16_t numPixels() const { return target.numPixels(); }
+
+  virtual void setPixelColor(const uint16_t pixelNo, const uint32_t color);
+  virtual uint32_t getPixelColor(const uint16_t pixelNo) const { return target.getPixelColor(pixelNo); }
+  virtual void fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count);
+
+  virtual void setBrightness(const uint8_t brightness) { target.setBrightness(brightness); }
+  virtual uint8_t getBrightness() const { return target.getBrightness(); }
+
+  virtual uint32_t getIntensity(const uint8_t channel) const { return target.getIntensity(channel); }
+};
+
+#endif /* LEDBLENDSINK_H */
@@ -9,44 +9,104 @@
 // Copyright (c) 2020-21 by Andreas Trappmann
 // All rights reserved.
 
-//#define DEBUG 1
 #include <TrappmannRobotics.h>
 
 #include "LEDCluster.h"
+#include "LEDClusterArena.h"
+#include "LEDPixelSink.h"
+#include "LEDColor.h"
+#include "LEDPeakMeter.h"
+#include "LEDPixelSource.h"
+#include "LEDPulsar.h"
 #include "LEDStripTest.h"
+#include "LEDTrace.h"
+
+/*
+ * Memory management
+ */
+LEDClusterArena *LEDCluster::arena = NULL;
+
+void LEDCluster::useArena(LEDClusterArena *arena) {
+  LEDCluster::arena = arena;
+}
+
+void *LEDCluster::allocate(const size_t size) {
+  if (NULL != arena) {
+    return arena->allocate(size);
+  }
+  else return malloc(size);
+}
+
+void LEDCluster::release(void *block, const size_t size) {
+  if ((NULL != arena) && arena->contains(block)) {
+    arena->release(block, size);
+  }
+  else free(block);
+}
+
+void *LEDCluster::operator new(size_t size) noexcept {
+  return allocate(size);
+}
+
+void LEDCluster::operator delete(void *cluster, size_t size) {
+  release(cluster, size);
+}
 
 /*
  * Constructor & Destructor
  */
-LEDCluster::LEDCluster(const uint16_t length, const uint16_t width /* =1 */) {
-  SEROUT(F("LEDCluster::LEDCluster(") << length << ", " << width << ")\n");
+LEDCluster::LEDCluster(const uint16_t length, const uint16_t width /* =1 */, const uint8_t numRuns /* =0 */) {
+  TRACE(TRACE_ALLOC, TRACE_LEVEL_DEBUG, F("LEDCluster::LEDCluster(") << length << ", " << width << ", " << numRuns << ")\n");
   this->length = length;
-  this->pixels = new PixelColor[length];
   this->width = width;
+  this->numRuns = numRuns;
+  if (numRuns > 0) { // one color per run
+    this->pixels = (PixelColor *)allocate(numRuns * sizeof(PixelColor));
+    this->runLengths = (uint8_t *)allocate(numRuns);
+  }
+  else {
+    this->pixels = (PixelColor *)allocate(length * sizeof(PixelColor));
+    this->runLengths = NULL;
+  }
+  if (NULL != pixels) memset(pixels, 0, ((numRuns > 0) ? numRuns : length) * sizeof(PixelColor));
 
   direction = NoD;
   wrapAround = false;
   backAndForth = false;
   updateInterval = 0L;
+  startVelocity = 0L;
+  acceleration = 0L;
   startTime = 0L;
   startInterval = 0L;
   startPosition = 0;
-  saturationInterval = 0;
-  peakLength = 0;
-  sourceHue = 0;
+  layer = 0;
+  blendMode = BlendReplace;
 
   position = 0;
+  fraction = 0;
+  velocity = 0L;
+  lastMotion = 0L;
   done = false;
   lastUpdate = 0L;
+  dirty = true;
+  dirtyStart = dirtyEnd = 0;
+  shownStart = 0;
+  shownEnd = 0;
 }
 
 LEDCluster::~LEDCluster() {
-  SEROUT(millis() << F(": delete LEDCluster\n"));
-  if (NULL != pixels) delete[] pixels; pixels = NULL;
+  TRACE(TRACE_ALLOC, TRACE_LEVEL_DEBUG, millis() << F(": delete LEDCluster\n"));
+  if (numRuns > 0) {
+    if (NULL != pixels) release(pixels, numRuns * sizeof(PixelColor));
+    if (NULL != runLengths) release(runLengths, numRuns);
+  }
+  else if (NULL != pixels) release(pixels, length * sizeof(PixelColor));
+  pixels = NULL;
+  runLengths = NULL;
 }
 
 bool LEDCluster::isInitialized() {
-  if (NULL != pixels) {
+  if ((NULL != pixels) && ((0 == numRuns) || (NULL != runLengths))) {
     return true;
   }
   else return false;
@@ -57,35 +117,52 @@ bool LEDCluster::isInitialized() {
  */
 LEDCluster *LEDCluster::initRGBPixel(const uint32_t color, const uint16_t width /* =1 */) {
   LEDCluster *cluster = new LEDCluster(1, width);
-  if (cluster->isInitialized()) {
+  if ((NULL != cluster) && cluster->isInitialized()) {
     cluster->setRGBPixel(0, color);
     return cluster;
   }
-  else return NULL;
+  else {
+    delete cluster;
+    return NULL;
+  }
 }
 
 LEDCluster *LEDCluster::initRGBRainbow(const uint16_t length) {
   LEDCluster *cluster = new LEDCluster(length);
-  if (cluster->isInitialized()) {
+  if ((NULL != cluster) && cluster->isInitialized()) {
     const uint16_t spread = 65536L / length;
     for (uint16_t i=0; i<length; i++) {
-#ifdef USE_DOTSTAR
-      uint32_t color = Adafruit_DotStar::gamma32(Adafruit_DotStar::ColorHSV(spread*i));
-#elif USE_NEOPIXEL
-      uint32_t color = Adafruit_NeoPixel::gamma32(Adafruit_NeoPixel::ColorHSV(spread*i));
-#else
-#error Either define USE_NEOPIXEL or USE_DOTSTAR
-#endif
-      cluster->setRGBPixel(i, color);
+      cluster->setRGBPixel(i, gammaColorHSV(spread*i));
     }
     return cluster;
   }
-  else return NULL;
+  else {
+    delete cluster;
+    return NULL;
+  }
 }
 
 LEDCluster *LEDCluster::initRGBPattern(const uint32_t color, const uint8_t pattern) {
+  uint32_t colors[8];
+  uint8_t runLengths[8];
+  uint8_t numRuns = 0;
+  for (uint8_t bit=0; bit<8; bit++) {
+    bool isSet = (0 != (pattern & (1 << bit)));
+    if ((bit > 0) && (isSet == (0 != (pattern & (1 << (bit-1)))))) {
+      runLengths[numRuns-1]++; // continue run
+    }
+    else {
+      colors[numRuns] = isSet ? color : COLOR_BLACK;
+      runLengths[numRuns++] = 1;
+    }
+  }
+
+  if (numRuns * (sizeof(PixelColor) + 1) < 8 * sizeof(PixelColor)) { // runs need less memory
+    return initRGBRuns(colors, runLengths, numRuns);
+  }
+
   LEDCluster *cluster = new LEDCluster(8);
-  if (cluster->isInitialized()) {
+  if ((NULL != cluster) && cluster->isInitialized()) {
     for (uint8_t bit=0; bit<8; bit++) {
       if (0 != (pattern & (1 << bit))) {
         cluster->setRGBPixel(bit, color);
@@ -94,104 +171,146 @@ LEDCluster *LEDCluster::initRGBPattern(const uint32_t color, const uint8_t patte
     }
     return cluster;
   }
-  else return NULL;
+  else {
+    delete cluster;
+    return NULL;
+  }
+}
+
+LEDCluster *LEDCluster::initRGBRuns(const uint32_t *colors, const uint8_t *runLengths, const uint8_t numRuns) {
+  if (0 == numRuns) return NULL;
+  uint16_t length = 0;
+  for (uint8_t run=0; run<numRuns; run++) {
+    length += runLengths[run];
+  }
+
+  LEDCluster *cluster = new LEDCluster(length, 1, numRuns);
+  if ((NULL != cluster) && cluster->isInitialized()) {
+    for (uint8_t run=0; run<numRuns; run++) {
+      cluster->runLengths[run] = runLengths[run];
+      cluster->pixels[run].rgbColor.red   = (colors[run] >> 16) & 0xff;
+      cluster->pixels[run].rgbColor.green = (colors[run] >> 8) & 0xff;
+      cluster->pixels[run].rgbColor.blue  = colors[run] & 0xff;
+    }
+    return cluster;
+  }
+  else {
+    delete cluster;
+    return NULL;
+  }
 }
 
 LEDCluster *LEDCluster::initPixelSource(const uint16_t length, const uint16_t hue) {
-  LEDCluster *cluster = new LEDCluster(length);
-  if (cluster->isInitialized()) {
-    cluster->setHSVPixel(length/2, hue, 255);
-    cluster->sourceHue = hue;
+  LEDCluster *cluster = new LEDPixelSource(length, hue);
+  if ((NULL != cluster) && cluster->isInitialized()) {
     return cluster;
   }
-  else return NULL;
+  else {
+    delete cluster;
+    return NULL;
+  }
 }
 
 LEDCluster *LEDCluster::initPeakMeter(const uint16_t length, const uint8_t peakLength) {
   if (peakLength >= length) return NULL;
-  LEDCluster *cluster = new LEDCluster(length+peakLength);
-  if (cluster->isInitialized()) {
-    cluster->peakLength = peakLength;
-    for (uint16_t i=0; i<length; i++) {
-      if (i < (length/2)) {
+  LEDCluster *cluster = new LEDPeakMeter(length, peakLength);
+  if ((NULL != cluster) && cluster->isInitialized()) {
+    // constant gradient of the whole bar, LEDPeakMeter shows it up to the level
+    uint16_t barLength = length + peakLength;
+    for (uint16_t i=0; i<barLength; i++) {
+      if (i < (barLength/2)) {
         cluster->setRGBPixel(i, COLOR_GREEN);
       }
-      else if (i < (length/2 + length/3)) {
+      else if (i < (barLength/2 + barLength/3)) {
         cluster->setRGBPixel(i, COLOR_YELLOW);
       }
       else {
         cluster->setRGBPixel(i, COLOR_RED);
       }
     }
-    for (uint16_t i=length; i<length+peakLength; i++) {
-      cluster->setRGBPixel(i, COLOR_BLACK);
-    }
     return cluster;
   }
-  else return NULL;
+  else {
+    delete cluster;
+    return NULL;
+  }
 }
 
 LEDCluster *LEDCluster::initPulsarPixel(const uint16_t hue, const uint8_t saturationInterval, const uint16_t width /* =1 */) {
-  LEDCluster *cluster = new LEDCluster(1, width);
-  if (cluster->isInitialized()) {
+  LEDCluster *cluster = new LEDPulsar(1, width, saturationInterval);
+  if ((NULL != cluster) && cluster->isInitialized()) {
     cluster->setHSVPixel(0, hue, saturationInterval);
-    cluster->saturationInterval = saturationInterval;
     return cluster;
   }
-  else return NULL;
+  else {
+    delete cluster;
+    return NULL;
+  }
 }
 
 LEDCluster *LEDCluster::initPulsarRainbow(const uint8_t saturationInterval, const uint16_t length) {
-  LEDCluster *cluster = new LEDCluster(length);
-  if (cluster->isInitialized()) {
+  LEDCluster *cluster = new LEDPulsar(length, 1, saturationInterval);
+  if ((NULL != cluster) && cluster->isInitialized()) {
     const uint16_t spread = 65536L / length;
     for (uint16_t i=0; i<length; i++) {
       cluster->setHSVPixel(i, spread*i, saturationInterval);
     }
-    cluster->saturationInterval = saturationInterval;
     return cluster;
   }
-  else return NULL;
+  else {
+    delete cluster;
+    return NULL;
+  }
 }
 
 /*
  * getter & setter
  */
 void LEDCluster::setRGBPixel(const uint16_t no, const uint32_t color) {
-  SEROUT(F("LEDCluster::setRGBPixel(") << no << ", " << toHexString(color) << ")\n");
+  TRACE(TRACE_RENDER, TRACE_LEVEL_DEBUG, F("LEDCluster::setRGBPixel(") << no << ", " << toHexString(color) << ")\n");
   if (no < length) {
-    pixels[no].rgbColor.red   = (color >> 16) & 0xff;
-    pixels[no].rgbColor.green = (color >> 8) & 0xff;
-    pixels[no].rgbColor.blue  = color & 0xff;
+    uint16_t index = (numRuns > 0) ? getRunIndex(no) : no; // sets the color of the whole run
+    pixels[index].rgbColor.red   = (color >> 16) & 0xff;
+    pixels[index].rgbColor.green = (color >> 8) & 0xff;
+    pixels[index].rgbColor.blue  = color & 0xff;
+    dirty = true;
   }
 }
 
 uint32_t LEDCluster::getRGBPixel(const uint16_t no) const {
-  SEROUT(F("LEDCluster::getRGBPixel(") << no << ")\n");
   if (no < length) {
-    uint32_t color = ((uint32_t)pixels[no].rgbColor.red << 16) | ((uint32_t)pixels[no].rgbColor.green << 8) | (uint32_t)pixels[no].rgbColor.blue;
-    SEROUT(F("LEDCluster::getRGBPixel(") << no << ") color=" << toHexString(color) << LF);
+    uint16_t index = (numRuns > 0) ? getRunIndex(no) : no;
+    uint32_t color = ((uint32_t)pixels[index].rgbColor.red << 16) | ((uint32_t)pixels[index].rgbColor.green << 8) | (uint32_t)pixels[index].rgbColor.blue;
+    TRACE(TRACE_RENDER, TRACE_LEVEL_DEBUG, F("LEDCluster::getRGBPixel(") << no << ") color=" << toHexString(color) << LF);
     return color;
   }
   else return 0L;
 }
 
+uint8_t LEDCluster::getRunIndex(const uint16_t no) const {
+  uint16_t runStart = 0;
+  for (uint8_t run=0; run<numRuns; run++) {
+    runStart += runLengths[run];
+    if (no < runStart) return run;
+  }
+  return numRuns-1;
+}
+
+uint32_t LEDCluster::getRunColor(const uint8_t run) const {
+  return ((uint32_t)pixels[run].rgbColor.red << 16) | ((uint32_t)pixels[run].rgbColor.green << 8) | (uint32_t)pixels[run].rgbColor.blue;
+}
+
 void LEDCluster::setHSVPixel(const uint16_t no, const uint16_t hue, const uint8_t saturation) {
-  if (no < length) {
+  if ((no < length) && (0 == numRuns)) {
     pixels[no].hsvColor.hue = hue;
     pixels[no].hsvColor.saturation = saturation;
+    dirty = true;
   }
 }
 
 uint32_t LEDCluster::getHSVPixel(const uint16_t no) const {
-  if (no < length) {
-#ifdef USE_DOTSTAR
-    return Adafruit_DotStar::gamma32(Adafruit_DotStar::ColorHSV(pixels[no].hsvColor.hue, pixels[no].hsvColor.saturation, 255));
-#elif USE_NEOPIXEL
-    return Adafruit_NeoPixel::gamma32(Adafruit_NeoPixel::ColorHSV(pixels[no].hsvColor.hue, pixels[no].hsvColor.saturation, 255));
-#else
-#error Either define USE_NEOPIXEL or USE_DOTSTAR
-#endif
+  if ((no < length) && (0 == numRuns)) {
+    return gammaColorHSV(pixels[no].hsvColor.hue, pixels[no].hsvColor.saturation);
   }
   else return 0L;
 }
@@ -210,10 +329,29 @@ void LEDCluster::enableBackAndForth() {
   wrapAround = false;   // exclusive with wrap-around
 }
 
+void LEDCluster::setLayer(const uint8_t layer) {
+  this->layer = layer;
+  dirty = true;
+}
+
+void LEDCluster::setBlendMode(const BlendMode mode) {
+  blendMode = mode;
+  dirty = true;
+}
+
 void LEDCluster::setUpdateInterval(const uint32_t interval) {
   updateInterval = interval;
 }
 
+void LEDCluster::setVelocity(const int32_t velocity) {
+  startVelocity = velocity;
+  this->velocity = velocity;
+}
+
+void LEDCluster::setAcceleration(const int32_t acceleration) {
+  this->acceleration = acceleration;
+}
+
 void LEDCluster::setStartInterval(const uint32_t interval) {
   startInterval = interval;
 }
@@ -223,8 +361,11 @@ void LEDCluster::setStartPosition(const int32_t pos) {
 }
 
 void LEDCluster::setStartTime(const uint32_t time) {
-  SEROUT(millis() << F(": restarting cluster at ") << time << LF);
+  TRACE(TRACE_SCHEDULE, TRACE_LEVEL_DEBUG, millis() << F(": restarting cluster at ") << time << LF);
   startTime = time;
+  lastUpdate = time;  // start moving at start time
+  lastMotion = time;
+  velocity = startVelocity;
 }
 
 /*
@@ -232,65 +373,238 @@ void LEDCluster::setStartTime(const uint32_t time) {
  */
 void LEDCluster::setPosition(const int32_t pos) {
   position = pos;
+  fraction = 0;
 }
 
-bool LEDCluster::shouldMove() {
-  uint32_t currentTime = millis();
-  if (currentTime - lastUpdate > updateInterval) {
-    lastUpdate = currentTime;
-    return true;
-  }
-  else return false;
+void LEDCluster::setFixedPosition(const int32_t fixedPosition) {
+  uint16_t newFraction = fixedPosition & 0xffff;
+  if ((newFraction >> 8) != (fraction >> 8)) dirty = true; // edge pixels change
+  position = fixedPosition >> 16;  // arithmetic shift rounds down negative positions, too
+  fraction = newFraction;
 }
 
-bool LEDCluster::hasPixel(const uint16_t pixelNo) const {
-  if ((pixelNo < position) || (pixelNo >= position+(length*width))) {
+void LEDCluster::accelerate(const uint32_t millis) {
+  // acceleration * millis / 1000 without overflow of 32 bits
+  velocity += (acceleration / 1000L) * (int32_t)millis + ((acceleration % 1000L) * (int32_t)millis) / 1000L;
+}
+
+uint32_t LEDCluster::getNextMotion() const {
+  if (0L != acceleration) return lastMotion;  // speed changes with every millisecond
+
+  // time to move by 1/16 pixel
+  uint32_t speed = (velocity < 0L) ? -velocity : velocity;
+  if (0L == speed) return lastMotion + 0x7fffffffL;
+  return lastMotion + (65536L/16 * 1000L) / speed;
+}
+
+bool LEDCluster::isStarted(const uint32_t now) const {
+  if ((startInterval > 0L) && (startTime > now)) { // not yet
     return false;
   }
   else return true;
 }
 
-bool LEDCluster::isPulsar() const {
-  if (saturationInterval > 0) {
-    return true;
+void LEDCluster::restartOrFinish(const uint32_t now) {
+  if (startInterval > 0L) {
+    setStartTime(startInterval + now);
+    setPosition(startPosition);
   }
-  else return false;
+  else markDone();
 }
 
-bool LEDCluster::isPeakMeter() const {
-  if (peakLength > 0) {
-    return true;
+void LEDCluster::step(const int32_t stripLength, const uint32_t now) {
+  int32_t newPosition = position;
+
+  switch (direction) {
+    case NoD: // no direction
+      break;
+    case LtR: // left to right
+      newPosition++;
+      break;
+    case RtL: // right to left
+      newPosition--;
+      break;
+    case BaF: // back and forth, see enableBackAndForth()
+      break;
   }
-  else return false;
+
+  if (newPosition <= 0L - length) {
+    if (wrapAround) {
+      setPosition(stripLength-1);
+    }
+    else if (backAndForth) {
+      setDirection(LtR);
+    }
+    else restartOrFinish(now);
+  }
+  else if (newPosition >= stripLength) {
+    if (wrapAround) {
+      setPosition(1L - length);
+    }
+    else if (backAndForth) {
+      setDirection(RtL);
+    }
+    else restartOrFinish(now);
+  }
+  else setPosition(newPosition);
 }
 
-bool LEDCluster::isPixelSource() const {
-  if (sourceHue > 0) {
-    return true;
+void LEDCluster::glide(const int32_t stripLength, const uint32_t now) {
+  uint32_t elapsed = now - lastMotion;
+  if (0L == elapsed) return;
+  if (elapsed > 1000L) elapsed = 1000L; // limit catch-up
+  lastMotion = now;
+
+  accelerate(elapsed);
+  int32_t distance = (velocity / 1000L) * (int32_t)elapsed + ((velocity % 1000L) * (int32_t)elapsed) / 1000L;
+  int32_t fixedPosition = getFixedPosition() + distance;
+
+  // lengths within the range of the 16.16 fixed-point position, so nothing below overflows 32 bits
+  int32_t spanLength = (int32_t)length * width;
+  if (spanLength > 32767L) spanLength = 32767L;
+  int32_t endOfStrip = (stripLength < 32767L) ? stripLength : 32767L;
+  if ((fixedPosition <= -spanLength * 65536L) || (fixedPosition >= endOfStrip * 65536L)) { // out of LED strip
+    if (wrapAround) { // enter at other end
+      if (fixedPosition < 0L) {
+        fixedPosition += endOfStrip * 65536L;
+        fixedPosition += spanLength * 65536L;
+      }
+      else {
+        fixedPosition -= endOfStrip * 65536L;
+        fixedPosition -= spanLength * 65536L;
+      }
+    }
+    else if (backAndForth) {
+      reverseVelocity();
+      return;
+    }
+    else {
+      restartOrFinish(now);
+      return;
+    }
   }
-  else return false;
+  setFixedPosition(fixedPosition);
+}
+
+void LEDCluster::markDirty(const uint16_t first, const uint16_t end) {
+  if (first >= end) return;
+  if ((width > 1) || (numRuns > 0)) { // pixels are replicated
+    dirty = true;
+  }
+  else if (dirtyStart < dirtyEnd) { // extend changed range
+    if (first < dirtyStart) dirtyStart = first;
+    if (end > dirtyEnd) dirtyEnd = end;
+  }
+  else {
+    dirtyStart = first;
+    dirtyEnd = end;
+  }
+}
+
+void LEDCluster::setShownSpan(const uint16_t first, const uint16_t end) {
+  shownStart = first;
+  shownEnd = end;
+  dirty = false;
+  dirtyStart = dirtyEnd = 0;
 }
 
-uint32_t LEDCluster::getPixelColorAtIndex(const uint16_t pixelNo) {
+uint32_t LEDCluster::getElapsedSteps(const uint32_t now) {
+  if (updateInterval == 0L) { // one step with every new millisecond
+    if (now != lastUpdate) {
+      lastUpdate = now;
+      return 1L;
+    }
+    else return 0L;
+  }
+
+  // advance lastUpdate by whole steps only, so the remainder is not lost
+  uint32_t steps = (now - lastUpdate) / updateInterval;
+  lastUpdate += steps * updateInterval;
+  return steps;
+}
+
+bool LEDCluster::hasPixel(const uint16_t pixelNo) const {
+  if ((pixelNo < getSpanStart()) || (pixelNo >= getPixelsEnd())) {
+    return false;
+  }
+  else return true;
+}
+
+uint32_t LEDCluster::getPixelColorAtIndex(const uint16_t pixelNo) const {
   if (!hasPixel(pixelNo)) return 0L;
   uint16_t absIndex = pixelNo - position;
   uint16_t index = absIndex % length;
-  uint32_t color = getRGBPixel(index);
-  SEROUT(F("LEDCluster::getPixelColorAtIndex(") << pixelNo << F(") idx=") << index << F(", color=") << toHexString(color) << LF);
+  uint32_t color = getColor(index);
+  TRACE(TRACE_RENDER, TRACE_LEVEL_DEBUG, F("LEDCluster::getPixelColorAtIndex(") << pixelNo << F(") idx=") << index << F(", color=") << toHexString(color) << LF);
   return color;
 }
 
-uint32_t LEDCluster::getPulsarAtIndex(const uint16_t pixelNo) {
-  if (!hasPixel(pixelNo)) return 0L;
-  int32_t absIndex = pixelNo - position;
-  int32_t index = absIndex % length;
-  pixels[index].hsvColor.saturation += saturationInterval;
-#ifdef USE_DOTSTAR
-  uint32_t color = Adafruit_DotStar::gamma32(Adafruit_DotStar::ColorHSV(pixels[index].hsvColor.hue, pixels[index].hsvColor.saturation, 255));
-#elif USE_NEOPIXEL
-  uint32_t color = Adafruit_NeoPixel::gamma32(Adafruit_NeoPixel::ColorHSV(pixels[index].hsvColor.hue, pixels[index].hsvColor.saturation, 255));
-#else
-#error Either define USE_NEOPIXEL or USE_DOTSTAR
-#endif
-  return color;
+/*
+ * behavior of a static RGB cluster, overwritten by other kinds of clusters
+ */
+bool LEDCluster::isAnimated() const {
+  if (direction != NoD) {
+    return true;
+  }
+  else return false;
+}
+
+void LEDCluster::update(const uint32_t steps) {
+  // static pixels
+}
+
+uint32_t LEDCluster::getColor(const uint16_t no) const {
+  return getRGBPixel(no);
+}
+
+void LEDCluster::render(LEDPixelSink &strip, const uint16_t firstPixel, const uint16_t endPixel) const {
+  if (firstPixel >= endPixel) return;
+
+  /*
+   * a single color cluster fills its whole span at once
+   */
+  if (isUniform()) {
+    strip.fill(getColor(0), firstPixel, endPixel-firstPixel);
+    return;
+  }
+
+  /*
+   * a run-length encoded cluster fills every run of every replica at once
+   */
+  if (numRuns > 0) {
+    int32_t replicaStart = position;
+    if (replicaStart < firstPixel) { // skip replicas in front of firstPixel
+      replicaStart += ((firstPixel - replicaStart) / length) * length;
+    }
+    for (; replicaStart<endPixel; replicaStart+=length) {
+      int32_t runStart = replicaStart;
+      for (uint8_t run=0; (run<numRuns) && (runStart<endPixel); run++) {
+        int32_t runEnd = runStart + runLengths[run];
+        int32_t first = (runStart < firstPixel) ? firstPixel : runStart;
+        int32_t end = (runEnd > endPixel) ? endPixel : runEnd;
+        if (first < end) {
+          strip.fill(getRunColor(run), first, end-first);
+        }
+        runStart = runEnd;
+      }
+    }
+    return;
+  }
+
+  /*
+   * the pixels of the cluster repeat width times along the LED strip,
+   * so look up the color of every pixel once and set all of its replicas
+   */
+  for (uint16_t index=0; index<length; index++) {
+    int32_t pixelNo = position + index;
+    if (pixelNo < firstPixel) { // skip replicas in front of firstPixel
+      pixelNo += ((firstPixel - pixelNo + length - 1) / length) * length;
+    }
+    if (pixelNo >= endPixel) continue;
+
+    uint32_t color = getColor(index);
+    for (; pixelNo<endPixel; pixelNo+=length) {
+      strip.setPixelColor(pixelNo, color);
+    }
+  }
 }
@@ -10,6 +10,9 @@
 
 #include "Arduino.h"
 
+class LEDClusterArena;
+class LEDPixelSink;
+
 #define COLOR_RED     ((uint32_t)0xFF0000)
 #define COLOR_GREEN   ((uint32_t)0x00FF00)
 #define COLOR_YELLOW  ((uint32_t)0xFFFF00)
@@ -39,12 +42,26 @@ enum Direction {
   BaF   // back and forth
 };
 
+#define FIXED16(value)  ((int32_t)((value) * 65536L))  // 16.16 fixed-point, e.g. FIXED16(2.5) pixels per second
+
+enum BlendMode {
+  BlendReplace, // pixels of cluster replace pixels below
+  BlendAdd,     // pixels of cluster are added to pixels below, saturated per color
+  BlendMax      // maximum of cluster and pixels below per color
+};
+
 class LEDCluster {
-private:
+protected:
   uint16_t    length;           // length of pixels array
   PixelColor  *pixels;          // array of colors for the LEDs in the cluster
   uint16_t    width;            // width of pixels array (multiplication factor)
+  uint8_t     numRuns;          // number of runs, if pixels are run-length encoded, else 0
+  uint8_t     *runLengths;      // array of run lengths; pixels holds one color per run
+
+  static void *allocate(const size_t size);   // from the arena, if any, else from the heap
+  static void release(void *block, const size_t size);
 
+private:
   /*
    * attributes of the LEDCluster
    */
@@ -52,19 +69,36 @@ private:
   bool      wrapAround;         // restart cluster at other end of LED strip if it moves out of the end of the strip
   bool      backAndForth;       // change direction, when cluster reaches end of LED strip
   uint32_t  updateInterval;     // speed of movement in milliseconds
+  int32_t   startVelocity;      // speed of smooth movement in pixels per second, 16.16 fixed-point
+  int32_t   acceleration;       // acceleration of smooth movement in pixels per second^2, 16.16 fixed-point
   uint32_t  startTime;          // start time for activation of this cluster in milliseconds
   uint32_t  startInterval;      // periodic start interval in milliseconds
   int32_t   startPosition;      // position of this cluster in the LED strip, when the cluster gets started
-  uint8_t   saturationInterval; // pulse saturation
-  uint8_t   peakLength;
-  uint16_t  sourceHue;
+  uint8_t   layer;              // z-order: clusters of higher layers are composed on top of lower layers
+  BlendMode blendMode;          // composition with the pixels of lower clusters
 
   /*
    * control attributes for LEDClusterController
    */
   int32_t   position;         // current position; not an uint, may be negative!
+  uint16_t  fraction;         // sub-pixel part of position, 0.16 fixed-point
+  int32_t   velocity;         // current speed of smooth movement, 16.16 fixed-point
+  uint32_t  lastMotion;       // time of last smooth movement in milliseconds
   bool      done;             // flag, if cluster is done (will be deleted)
   uint32_t  lastUpdate;       // in milliseconds
+  bool      dirty;            // flag, if pixels changed since the cluster was shown last
+  uint16_t  dirtyStart;       // else range [dirtyStart, dirtyEnd) of pixels changed since the cluster was shown last
+  uint16_t  dirtyEnd;
+  uint16_t  shownStart;       // span [shownStart, shownEnd) of LED strip, where the cluster was shown last
+  uint16_t  shownEnd;
+
+  /*
+   * memory for clusters and their pixels, see useArena()
+   */
+  static LEDClusterArena *arena;
+
+  uint8_t getRunIndex(const uint16_t no) const;
+  void  restartOrFinish(const uint32_t now);  // when moved out of the LED strip
 
   /*
    * some handy initialization methods with predefined behavior
@@ -73,6 +107,7 @@ public:
   static LEDCluster *initRGBPixel(const uint32_t color, const uint16_t width = 1);
   static LEDCluster *initRGBRainbow(const uint16_t length);
   static LEDCluster *initRGBPattern(const uint32_t color, const uint8_t pattern);
+  static LEDCluster *initRGBRuns(const uint32_t *colors, const uint8_t *runLengths, const uint8_t numRuns);
 
   static LEDCluster *initPixelSource(const uint16_t length, const uint16_t hue);
   static LEDCluster *initPeakMeter(const uint16_t length, const uint8_t peakLength);
@@ -81,8 +116,13 @@ public:
   static LEDCluster *initPulsarRainbow(const uint8_t saturationInterval, const uint16_t width);
 
 public:
-  LEDCluster(const uint16_t length, const uint16_t width = 1);
-  ~LEDCluster();
+  LEDCluster(const uint16_t length, const uint16_t width = 1, const uint8_t numRuns = 0);
+  virtual ~LEDCluster();
+
+  static void *operator new(size_t size) noexcept;  // returns NULL if out of memory
+  static void operator delete(void *cluster, size_t size);
+
+  static void useArena(LEDClusterArena *arena);
 
   bool isInitialized();
 
@@ -103,6 +143,13 @@ public:
   void setUpdateInterval(const uint32_t interval);
   uint32_t getUpdateInterval() const  { return updateInterval; }
 
+  // smooth movement by fractions of pixels, independent of the frame rate; replaces direction and update interval
+  void setVelocity(const int32_t velocity);             // pixels per second, see FIXED16()
+  void setAcceleration(const int32_t acceleration);     // pixels per second^2, see FIXED16()
+  int32_t getVelocity() const     { return velocity; }
+  int32_t getAcceleration() const { return acceleration; }
+  bool isSmooth() const { return (0L != startVelocity) || (0L != acceleration); }
+
   void setStartTime(const uint32_t time);
   uint32_t getStartTime() const { return startTime; }
 
@@ -118,30 +165,75 @@ public:
   void  enableBackAndForth();
   bool  doBackAndForth() const  { return backAndForth; }
 
-  uint16_t getSourceHue() const { return sourceHue; }
+  void  setLayer(const uint8_t layer);  // before addCluster(), else use LEDClusterController::setLayer()
+  uint8_t getLayer() const  { return layer; }
+
+  void  setBlendMode(const BlendMode mode);
+  BlendMode getBlendMode() const  { return blendMode; }
 
   /*
    * controlling methods for LEDClusterController
    */
   uint16_t  getLength() const { return length; }
   uint16_t  getWidth() const { return width; }
-  uint8_t   getPeakLength() const { return peakLength; }
+  bool      isUniform() const { return (1 == length); }
+
+  uint8_t   getNumRuns() const  { return numRuns; }
+  uint8_t   getRunLength(const uint8_t run) const { return runLengths[run]; }
+  uint32_t  getRunColor(const uint8_t run) const;
 
   void    setPosition(const int32_t pos);
   int32_t getPosition() const { return position; }
 
+  void    setFixedPosition(const int32_t fixedPosition);  // 16.16 fixed-point, limits position to +-32767
+  int32_t getFixedPosition() const  { return position * 65536L + fraction; }
+  uint8_t getCoverage() const   { return fraction >> 8; } // covered part of the pixel behind the cluster, 0..255
+
+  void    accelerate(const uint32_t millis);
+  void    reverseVelocity()     { velocity = -velocity; }
+  void    setLastMotion(const uint32_t time) { lastMotion = time; }
+  uint32_t getLastMotion() const  { return lastMotion; }
+  uint32_t getNextMotion() const;
+
+  /*
+   * motion rules on a LED strip of stripLength pixels, shared by LEDClusterController and LEDHostRenderer
+   */
+  bool  isStarted(const uint32_t now) const;                // false, while the periodic start is still pending
+  void  step(const int32_t stripLength, const uint32_t now);  // move by one pixel in direction of movement
+  void  glide(const int32_t stripLength, const uint32_t now); // move smoothly by the time elapsed since last motion
+
   void  markDone()      { done = true; }
   bool  isDone() const  { return done; }
 
+  void  markDirty()     { dirty = true; }
+  void  markDirty(const uint16_t first, const uint16_t end);  // only pixels [first, end) changed
+  bool  isDirty() const { return dirty || (dirtyStart < dirtyEnd); }
+  bool  isPartlyDirty() const { return !dirty && (dirtyStart < dirtyEnd); }
+  uint16_t getDirtyStart() const  { return dirtyStart; }
+  uint16_t getDirtyEnd() const    { return dirtyEnd; }
+
+  void  setShownSpan(const uint16_t first, const uint16_t end);
+  uint16_t getShownStart() const  { return shownStart; }
+  uint16_t getShownEnd() const    { return shownEnd; }
+
+  int32_t getSpanStart() const  { return position; }                         // first pixel of LED strip covered by cluster
+  int32_t getPixelsEnd() const  { return position + (int32_t)length*width; }  // first pixel behind the pixels of the cluster
+  int32_t getSpanEnd() const    { return getPixelsEnd() + ((getCoverage() > 0) ? 1 : 0); } // first pixel behind cluster
+
   bool  hasPixel(const uint16_t pixelNo) const;
-  bool  isPulsar() const;
-  bool  isPeakMeter() const;
-  bool  isPixelSource() const;
+  uint32_t getPixelColorAtIndex(const uint16_t pixelNo) const;
 
-  uint32_t getPixelColorAtIndex(const uint16_t pixelNo);
-  uint32_t getPulsarAtIndex(const uint16_t pixelNo);
+  void  setLastUpdate(const uint32_t time) { lastUpdate = time; }
+  uint32_t getNextUpdate() const  { return lastUpdate + updateInterval; }
+  uint32_t getElapsedSteps(const uint32_t now);
 
-  bool  shouldMove();
+  /*
+   * behavior of the kind of cluster, called once per cluster and frame by LEDClusterController
+   */
+  virtual bool isAnimated() const;                      // true, if update() changes the pixels
+  virtual void update(const uint32_t steps);            // advance pixels by the number of elapsed update steps
+  virtual uint32_t getColor(const uint16_t no) const;   // color of pixel no of the cluster
+  virtual void render(LEDPixelSink &strip, const uint16_t firstPixel, const uint16_t endPixel) const;
 
 };
 
@@ -0,0 +1,73 @@
+// NAME: LEDClusterArena.cpp
+//
+// DESC: Fixed size memory arena for LEDClusters and their pixel arrays.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDClusterArena.h"
+#include "LEDTrace.h"
+
+LEDClusterArena::LEDClusterArena(const uint16_t capacity) {
+  memory = (uint8_t *)malloc(capacity);
+  this->capacity = (NULL != memory) ? capacity : 0;
+  used = 0;
+  allocated = 0;
+  highWaterMark = 0;
+  for (uint8_t sizeClass=0; sizeClass<ARENA_NUM_SIZE_CLASSES; sizeClass++) {
+    freeBlocks[sizeClass] = NULL;
+  }
+}
+
+LEDClusterArena::~LEDClusterArena() {
+  if (NULL != memory) free(memory);
+  memory = NULL;
+}
+
+uint8_t LEDClusterArena::getSizeClass(const size_t size) {
+  uint8_t sizeClass = 0;
+  size_t blockSize = ARENA_MIN_BLOCK_SIZE;
+  while ((blockSize < size) && (sizeClass < ARENA_NUM_SIZE_CLASSES)) {
+    blockSize <<= 1;
+    sizeClass++;
+  }
+  return sizeClass;
+}
+
+void *LEDClusterArena::allocate(const size_t size) {
+  uint8_t sizeClass = getSizeClass(size);
+  if (sizeClass >= ARENA_NUM_SIZE_CLASSES) return NULL;
+  uint16_t blockSize = ARENA_MIN_BLOCK_SIZE << sizeClass;
+
+  void *block = freeBlocks[sizeClass];
+  if (NULL != block) { // reuse released block
+    freeBlocks[sizeClass] = *(void **)block;
+  }
+  else if (blockSize <= capacity - used) { // carve new block
+    block = memory + used;
+    used += blockSize;
+  }
+  else {
+    TRACE(TRACE_ALLOC, TRACE_LEVEL_ERROR, F("LEDClusterArena::allocate(") << size << F(") out of memory\n"));
+    return NULL;
+  }
+
+  allocated += blockSize;
+  if (allocated > highWaterMark) highWaterMark = allocated;
+  return block;
+}
+
+void LEDClusterArena::release(void *block, const size_t size) {
+  if (NULL == block) return;
+  uint8_t sizeClass = getSizeClass(size);
+  *(void **)block = freeBlocks[sizeClass];
+  freeBlocks[sizeClass] = block;
+  allocated -= ARENA_MIN_BLOCK_SIZE << sizeClass;
+}
+
+bool LEDClusterArena::contains(const void *block) const {
+  if ((block >= memory) && (block < memory + used)) {
+    return true;
+  }
+  else return false;
+}
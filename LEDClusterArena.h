@@ -0,0 +1,51 @@
+// NAME: LEDClusterArena.h
+//
+// DESC: Fixed size memory arena for LEDClusters and their pixel arrays.
+//
+//       The arena allocates one block of memory at construction and carves blocks
+//       of power-of-two size classes from it. Released blocks are kept in a free
+//       list per size class and are reused by the next allocation of the same class.
+//       So clusters can be created and deleted over and over again without
+//       fragmenting the heap.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDCLUSTERARENA_H
+#define LEDCLUSTERARENA_H
+
+#include <Arduino.h>
+
+#define ARENA_MIN_BLOCK_SIZE    (sizeof(void*) < 4 ? 4 : sizeof(void*))  // smallest size class, holds the free list pointer
+#define ARENA_NUM_SIZE_CLASSES  12  // size classes from ARENA_MIN_BLOCK_SIZE up to 2048 * ARENA_MIN_BLOCK_SIZE
+
+class LEDClusterArena {
+private:
+  uint8_t   *memory;          // memory block of the arena
+  uint16_t  capacity;         // size of memory block in bytes
+  uint16_t  used;             // bytes carved from memory block so far
+  uint16_t  allocated;        // bytes currently allocated, rounded to size classes
+  uint16_t  highWaterMark;    // maximum of allocated bytes
+  void      *freeBlocks[ARENA_NUM_SIZE_CLASSES]; // lists of released blocks per size class
+
+  static uint8_t getSizeClass(const size_t size);
+
+public:
+  LEDClusterArena(const uint16_t capacity);
+  ~LEDClusterArena();
+
+  void *allocate(const size_t size);
+  void release(void *block, const size_t size);
+  bool contains(const void *block) const;
+
+  // size of the block allocated for size bytes, for the capacity of an arena at compile time
+  static constexpr uint16_t getBlockSize(const size_t size, const uint16_t blockSize = ARENA_MIN_BLOCK_SIZE) {
+    return (blockSize >= size) ? blockSize : getBlockSize(size, blockSize << 1);
+  }
+
+  uint16_t getCapacity() const      { return capacity; }
+  uint16_t getFreeBytes() const     { return capacity - allocated; }
+  uint16_t getHighWaterMark() const { return highWaterMark; }
+};
+
+#endif /* LEDCLUSTERARENA_H */
@@ -1,299 +1,746 @@
 // NAME: LEDClusterController.cpp
 //
-// DESC:
-//
-// DEPENDENCIES:
-//  Adafruit_DotStar library from https://github.com/adafruit/Adafruit_DotStar
-//  Adafruit_NeoPixel library from https://github.com/adafruit/Adafruit_NeoPixel
+// DESC: Control a group of LEDClusters and animate their behavior on an LED strip.
 //
 // Copyright (c) 2020-21 by Andreas Trappmann
 // All rights reserved.
 
-//#define DEBUG 1
 #include <TrappmannRobotics.h>
 
 #include "LEDClusterController.h"
+#include "LEDBlendSink.h"
 #include "LEDCluster.h"
+#include "LEDScene.h"
+#include "LEDTrace.h"
 
-#ifdef USE_DOTSTAR
-LEDClusterController::LEDClusterController(const uint16_t numLEDs, const uint8_t ledConfig, const uint8_t maxClusters)
-                     :Adafruit_DotStar(numLEDs, ledConfig) {
-  this->maxClusters = maxClusters;
-  clusters = new LEDClusterPtr[maxClusters];
-  numClusters = 0;
-}
-
-LEDClusterController::LEDClusterController(const uint16_t numLEDs, const uint8_t dataPin, const uint8_t clockPin, const uint8_t ledConfig, const uint8_t maxClusters)
-                     :Adafruit_DotStar(numLEDs, dataPin, clockPin, ledConfig) {
-  this->maxClusters = maxClusters;
-  clusters = new LEDClusterPtr[maxClusters];
-  numClusters = 0;
-}
-#elif USE_NEOPIXEL
-LEDClusterController::LEDClusterController(const uint16_t numLEDs, const uint8_t dataPin, const uint8_t ledConfig, const uint8_t maxClusters)
-                     :Adafruit_NeoPixel(numLEDs, dataPin, ledConfig) {
-  this->maxClusters = maxClusters;
-  clusters = new LEDClusterPtr[maxClusters];
+LEDClusterController::LEDClusterController(LEDPixelSink &strip, const uint16_t maxClusters, const uint16_t arenaSize)
+                     :strip(strip), arena(arenaSize) {
+  this->maxClusters = (maxClusters < NO_SLOT) ? maxClusters : NO_SLOT - 1;
+  clusters = new LEDClusterPtr[this->maxClusters];
+  generations = new uint16_t[this->maxClusters];
+  nextSlot = new uint16_t[this->maxClusters];
+  prevSlot = new uint16_t[this->maxClusters];
+  spanIndex = new uint16_t[this->maxClusters];
+  indexPos = new uint16_t[this->maxClusters];
+  longSpans = new uint16_t[this->maxClusters];
+  zRank = new uint16_t[this->maxClusters];
+  covering = new uint16_t[this->maxClusters];
+  for (uint16_t slot=0; slot<this->maxClusters; slot++) {
+    clusters[slot] = NULL;
+    generations[slot] = 1;
+    nextSlot[slot] = (slot+1 < this->maxClusters) ? slot+1 : NO_SLOT;
+    prevSlot[slot] = NO_SLOT;
+  }
+  firstSlot = lastSlot = NO_SLOT;
+  freeSlot = (this->maxClusters > 0) ? 0 : NO_SLOT;
   numClusters = 0;
+  maxSpanLength = 0;
+  numLongSpans = 0;
+  zOrderChanged = true;
+  numDamaged = 0;
+  brightness = 48;
+  powerBudget = 0;
+  LEDCluster::useArena(&arena);
 }
-#else
-#error Either define USE_NEOPIXEL or USE_DOTSTAR
-#endif
 
 LEDClusterController::~LEDClusterController() {
-  SEROUT(millis() << F(": delete LEDClusterController\n"));
+  TRACE(TRACE_ALLOC, TRACE_LEVEL_DEBUG, millis() << F(": delete LEDClusterController\n"));
+  LEDCluster::useArena(&arena); // release the clusters into their arena, even if another controller was created since
+  for (uint16_t slot=firstSlot; slot!=NO_SLOT; slot=nextSlot[slot]) {
+    delete clusters[slot];
+  }
   delete[] clusters; clusters = NULL;
+  delete[] generations; generations = NULL;
+  delete[] nextSlot; nextSlot = NULL;
+  delete[] prevSlot; prevSlot = NULL;
+  delete[] spanIndex; spanIndex = NULL;
+  delete[] indexPos; indexPos = NULL;
+  delete[] longSpans; longSpans = NULL;
+  delete[] zRank; zRank = NULL;
+  delete[] covering; covering = NULL;
+  LEDCluster::useArena(NULL);
 }
 
 void LEDClusterController::begin() {
-#ifdef USE_DOTSTAR
-  Adafruit_DotStar::begin(); // initialize pins for output
-  Adafruit_DotStar::show();  // turn off all LEDs
-  Adafruit_DotStar::setBrightness(48);
-
-  // test configuration setting, first 3 LEDs must be R-G-B
-  Adafruit_DotStar::setPixelColor(0, COLOR_RED);
-  Adafruit_DotStar::setPixelColor(1, COLOR_GREEN);
-  Adafruit_DotStar::setPixelColor(2, COLOR_BLUE);
-  Adafruit_DotStar::show();
-#elif USE_NEOPIXEL
-  Adafruit_NeoPixel::begin(); // initialize pins for output
-  Adafruit_NeoPixel::show();  // turn off all LEDs
-  Adafruit_NeoPixel::setBrightness(48);
+  strip.begin(); // initialize pins for output
+  strip.show();  // turn off all LEDs
+  strip.setBrightness(brightness);
 
   // test configuration setting, first 3 LEDs must be R-G-B
-  Adafruit_NeoPixel::setPixelColor(0, COLOR_RED);
-  Adafruit_NeoPixel::setPixelColor(1, COLOR_GREEN);
-  Adafruit_NeoPixel::setPixelColor(2, COLOR_BLUE);
-  Adafruit_NeoPixel::show();
-#else
-#error Either define USE_NEOPIXEL or USE_DOTSTAR
-#endif
+  strip.setPixelColor(0, COLOR_RED);
+  strip.setPixelColor(1, COLOR_GREEN);
+  strip.setPixelColor(2, COLOR_BLUE);
+  strip.show();
 
+  addDamage(0, numPixels()); // repaint whole LED strip with first frame
+  frameTime = millis();
   running = true;
 }
 
+void LEDClusterController::setBrightness(const uint8_t brightness) {
+  this->brightness = brightness;
+  addDamage(0, numPixels()); // apply with next frame
+}
+
+void LEDClusterController::setPowerBudget(const uint16_t milliAmps) {
+  powerBudget = milliAmps;
+  addDamage(0, numPixels()); // apply with next frame
+}
+
 void LEDClusterController::end() {
-#ifdef USE_DOTSTAR
-  Adafruit_DotStar::clear();
-  Adafruit_DotStar::show();
-#elif USE_NEOPIXEL
-  Adafruit_NeoPixel::clear();
-  Adafruit_NeoPixel::show();
-#else
-#error Either define USE_NEOPIXEL or USE_DOTSTAR
-#endif
+  strip.clear();
+  strip.show();
 
   running = false;
 }
 
-bool LEDClusterController::addCluster(const LEDCluster *cluster, const int32_t position /* =0 */) {
-  if (numClusters >= maxClusters) return false;
+LEDClusterHandle LEDClusterController::addCluster(LEDCluster *cluster, const int32_t position /* =0 */) {
+  if ((NULL == cluster) || (NO_SLOT == freeSlot)) return INVALID_CLUSTER_HANDLE;
 
   if (position < numPixels()) {
-    SEROUT(F("LEDClusterController::addCluster pos=") << position << LF);
+    TRACE(TRACE_SCHEDULE, TRACE_LEVEL_DEBUG, F("LEDClusterController::addCluster pos=") << position << LF);
     cluster->setStartPosition(position);
     cluster->setPosition(position);
-    clusters[numClusters++] = cluster;
-    return true;
+
+    // updates start now, or at the start time of a cluster started later
+    uint32_t updateStart = millis();
+    if ((cluster->getStartInterval() > 0L) && (cluster->getStartTime() > updateStart)) {
+      updateStart = cluster->getStartTime();
+    }
+    cluster->setLastUpdate(updateStart);
+    cluster->setLastMotion(updateStart);
+
+    // take slot from free list and put it on top of its layer
+    uint16_t slot = freeSlot;
+    freeSlot = nextSlot[slot];
+    clusters[slot] = cluster;
+    linkSlot(slot);
+
+    // append to span index, sortSpanIndex() moves it to its place
+    spanIndex[numClusters] = slot;
+    indexPos[slot] = numClusters;
+    numClusters++;
+
+    return ((LEDClusterHandle)generations[slot] << 16) | slot;
   }
 
-  return false;
+  return INVALID_CLUSTER_HANDLE;
 }
 
-void LEDClusterController::show() {
-  if (!running) return;
+bool LEDClusterController::removeCluster(const LEDClusterHandle handle) {
+  uint16_t slot = getSlot(handle);
+  if (NO_SLOT == slot) return false;
 
-  /*
-   * clear LED strip
-   */
-#ifdef USE_DOTSTAR
-  Adafruit_DotStar::clear();
-#elif USE_NEOPIXEL
-  Adafruit_NeoPixel::clear();
-#else
-#error Either define USE_NEOPIXEL or USE_DOTSTAR
-#endif
+  removeSlot(slot);
+  return true;
+}
 
-  /*
-   * set pixels of all clusters in LED strip
-   */
-  for (uint8_t clusterNo=0; clusterNo<numClusters; clusterNo++) {
-    LEDCluster *cluster = clusters[clusterNo];
-    if ((cluster->getStartInterval() > 0L) && (cluster->getStartTime() > millis())) { // not yet
-      continue;
-    }
+LEDCluster *LEDClusterController::getCluster(const LEDClusterHandle handle) const {
+  uint16_t slot = getSlot(handle);
+  return (NO_SLOT != slot) ? clusters[slot] : NULL;
+}
+
+bool LEDClusterController::setLayer(const LEDClusterHandle handle, const uint8_t layer) {
+  uint16_t slot = getSlot(handle);
+  if (NO_SLOT == slot) return false;
+
+  unlinkSlot(slot);
+  clusters[slot]->setLayer(layer);
+  linkSlot(slot);
+  return true;
+}
+
+/*
+ * scenes
+ */
+static uint8_t readSceneByte(const uint8_t *&scene) {
+  return pgm_read_byte(scene++);
+}
+
+static uint16_t readScene16(const uint8_t *&scene) {
+  uint16_t value = readSceneByte(scene);
+  return value | ((uint16_t)readSceneByte(scene) << 8);
+}
+
+static uint32_t readScene32(const uint8_t *&scene) {
+  uint32_t value = readScene16(scene);
+  return value | ((uint32_t)readScene16(scene) << 16);
+}
+
+static uint32_t readSceneColor(const uint8_t *&scene) {
+  uint32_t color = (uint32_t)readSceneByte(scene) << 16;
+  color |= (uint32_t)readSceneByte(scene) << 8;
+  return color | readSceneByte(scene);
+}
+
+uint16_t LEDClusterController::loadScene(const uint8_t *scene) {
+  uint16_t numAdded = 0;
+  LEDCluster *cluster = NULL; // added, when all its modifiers are read
+  int16_t position = 0;
+  uint32_t loadTime = millis();
+
+  while (true) {
+    uint8_t op = readSceneByte(scene);
 
     /*
-     * modify pixels in cluster
+     * modifiers of the preceding cluster
      */
-    if (cluster->isPeakMeter() && cluster->shouldMove()) {
-      uint8_t peak = cluster->getPeakLength();
-      uint16_t len = cluster->getLength() - peak;
-      uint16_t width = random(len-peak, len+peak);
-      for (uint16_t i=0; i<width; i++) {
-        if (i < (width/2)) {
-          cluster->setRGBPixel(i, COLOR_GREEN);
-        }
-        else if (i < (width/2 + width/3)) {
-          cluster->setRGBPixel(i, COLOR_YELLOW);
+    if (op >= SCENE_OP_MODIFIER) {
+      switch (op) {
+        case SCENE_OP_MOVE: {
+          Direction direction = (Direction)readSceneByte(scene);
+          uint32_t interval = readScene32(scene);
+          if (NULL != cluster) {
+            cluster->setDirection(direction);
+            cluster->setUpdateInterval(interval);
+          }
+          break;
         }
-        else {
-          cluster->setRGBPixel(i, COLOR_RED);
+        case SCENE_OP_WRAP_AROUND:
+          if (NULL != cluster) cluster->enableWrapAround();
+          break;
+        case SCENE_OP_BACK_AND_FORTH:
+          if (NULL != cluster) cluster->enableBackAndForth();
+          break;
+        case SCENE_OP_START: {
+          uint32_t time = readScene32(scene);
+          uint32_t interval = readScene32(scene);
+          if (NULL != cluster) {
+            cluster->setStartInterval(interval);
+            cluster->setStartTime(loadTime + time);
+          }
+          break;
         }
-      }
-      for (uint16_t i=width; i<cluster->getLength(); i++) {
-        cluster->setRGBPixel(i, COLOR_BLACK);
-      }
-    }
-    else if (cluster->isPixelSource()) {
-      uint16_t center = cluster->getLength() / 2;
-      uint8_t saturationDelta = 255 / center;
-
-      // run backward from center
-      // copy pixel[i] to pixel[i-1] and reduce saturation
-      for (uint16_t i=1; i<center; i++) {
-        uint16_t hue = cluster->getHue(i);
-        uint16_t saturation = cluster->getSaturation(i);
-        if (saturation >= saturationDelta) {
-          cluster->setHSVPixel(i-1, hue, saturation-saturationDelta);
+        case SCENE_OP_LAYER: {
+          uint8_t layer = readSceneByte(scene);
+          BlendMode mode = (BlendMode)readSceneByte(scene);
+          if (NULL != cluster) {
+            cluster->setLayer(layer);
+            cluster->setBlendMode(mode);
+          }
+          break;
         }
-        else cluster->setRGBPixel(i-1, COLOR_BLACK);
-      }
-
-      // instantiate new pixel in center
-      cluster->setHSVPixel(center, cluster->getSourceHue(), 255);
-
-      // run outward from center
-      // copy pixel[i] to pixel[i+1] and reduce saturation
-      for (uint16_t i=cluster->getLength()-2; i>center; i--) {
-        uint16_t hue = cluster->getHue(i);
-        uint16_t saturation = cluster->getSaturation(i);
-        if (saturation >= saturationDelta) {
-          cluster->setHSVPixel(i+1, hue, saturation-saturationDelta);
+        case SCENE_OP_VELOCITY: {
+          int32_t velocity = readScene32(scene);
+          int32_t acceleration = readScene32(scene);
+          if (NULL != cluster) {
+            cluster->setVelocity(velocity);
+            cluster->setAcceleration(acceleration);
+          }
+          break;
         }
-        else cluster->setRGBPixel(i+1, COLOR_BLACK);
+        default:
+          TRACE(TRACE_SCHEDULE, TRACE_LEVEL_ERROR, F("loadScene: unknown modifier ") << op << LF);
+          if (NULL != cluster) delete cluster;
+          return numAdded;
       }
+      continue;
     }
 
     /*
-     * modify pixels in LED strip
+     * next cluster or end of scene: the preceding cluster is complete
      */
-    for (uint16_t pixelNo=0; pixelNo<numPixels(); pixelNo++) {
-      if (cluster->hasPixel(pixelNo)) {
-        uint32_t color;
-        if (cluster->isPulsar()) {
-          color = cluster->getPulsarAtIndex(pixelNo);
-        }
-        else {
-          color = cluster->getPixelColorAtIndex(pixelNo);
-        }
-#ifdef USE_DOTSTAR
-        Adafruit_DotStar::setPixelColor(pixelNo, color);
-#elif USE_NEOPIXEL
-        Adafruit_NeoPixel::setPixelColor(pixelNo, color);
-#else
-#error Either define USE_NEOPIXEL or USE_DOTSTAR
-#endif
-      }
+    if (NULL != cluster) {
+      if (addSceneCluster(cluster, position)) numAdded++;
+      cluster = NULL;
     }
 
-    if (cluster->shouldMove()) {
-      int32_t position = cluster->getPosition();
+    switch (op) {
+      case SCENE_OP_END:
+        return numAdded;
 
-      switch (cluster->getDirection()) {
-        case NoD: // no direction
-          break;
-        case LtR: // left to right
-          position++;
-          break;
-        case RtL: // right to left
-          position--;
-          break;
+      case SCENE_OP_RGB_PIXEL: {
+        uint32_t color = readSceneColor(scene);
+        cluster = LEDCluster::initRGBPixel(color, readScene16(scene));
+        break;
       }
-
-      int32_t length = cluster->getLength();
-      if (position <=  0L - length) {
-        if (cluster->doWrapAround()) {
-          cluster->setPosition(numPixels()-1);
-        }
-        else if (cluster->doBackAndForth()) {
-          cluster->setDirection(LtR);
-        }
-        else if (cluster->getStartInterval() > 0L) {
-          cluster->setStartTime(cluster->getStartInterval() + millis());
-          cluster->setPosition(cluster->getStartPosition());
-        }
-        else {
-          cluster->markDone();
-        }
+      case SCENE_OP_RGB_RAINBOW:
+        cluster = LEDCluster::initRGBRainbow(readScene16(scene));
+        break;
+      case SCENE_OP_RGB_PATTERN: {
+        uint32_t color = readSceneColor(scene);
+        cluster = LEDCluster::initRGBPattern(color, readSceneByte(scene));
+        break;
       }
-      else if (position >= numPixels()) {
-        if (cluster->doWrapAround()) {
-          position = 1L - length;
-          cluster->setPosition(1L - length);
-        }
-        else if (cluster->doBackAndForth()) {
-          cluster->setDirection(RtL);
-        }
-        else if (cluster->getStartInterval() > 0L) {
-          cluster->setStartTime(cluster->getStartInterval() + millis());
-          cluster->setPosition(cluster->getStartPosition());
-        }
-        else cluster->markDone();
+      case SCENE_OP_PULSAR_PIXEL: {
+        uint16_t hue = readScene16(scene);
+        uint8_t saturationInterval = readSceneByte(scene);
+        cluster = LEDCluster::initPulsarPixel(hue, saturationInterval, readScene16(scene));
+        break;
+      }
+      case SCENE_OP_PULSAR_RAINBOW: {
+        uint8_t saturationInterval = readSceneByte(scene);
+        cluster = LEDCluster::initPulsarRainbow(saturationInterval, readScene16(scene));
+        break;
+      }
+      case SCENE_OP_PIXEL_SOURCE: {
+        uint16_t length = readScene16(scene);
+        cluster = LEDCluster::initPixelSource(length, readScene16(scene));
+        break;
+      }
+      case SCENE_OP_PEAK_METER: {
+        uint16_t length = readScene16(scene);
+        cluster = LEDCluster::initPeakMeter(length, readSceneByte(scene));
+        break;
       }
-      else cluster->setPosition(position);
+      default:
+        TRACE(TRACE_SCHEDULE, TRACE_LEVEL_ERROR, F("loadScene: unknown cluster ") << op << LF);
+        return numAdded;
     }
+
+    position = readScene16(scene);
+    if (NULL == cluster) {
+      TRACE(TRACE_ALLOC, TRACE_LEVEL_ERROR, F("loadScene: out of memory for cluster ") << numAdded << LF);
+    }
+  }
+}
+
+bool LEDClusterController::addSceneCluster(LEDCluster *cluster, const int16_t position) {
+  if (INVALID_CLUSTER_HANDLE == addCluster(cluster, position)) {
+    delete cluster;
+    return false;
+  }
+  return true;
+}
+
+uint16_t LEDClusterController::getSlot(const LEDClusterHandle handle) const {
+  uint16_t slot = handle & 0xffff;
+  if ((slot < maxClusters) && (NULL != clusters[slot]) && (generations[slot] == (handle >> 16))) {
+    return slot;
+  }
+  else return NO_SLOT;
+}
+
+void LEDClusterController::linkSlot(const uint16_t slot) {
+  // insert behind the last slot of the same or a lower layer
+  uint8_t layer = clusters[slot]->getLayer();
+  uint16_t below = lastSlot;
+  while ((NO_SLOT != below) && (clusters[below]->getLayer() > layer)) {
+    below = prevSlot[below];
+  }
+
+  prevSlot[slot] = below;
+  if (NO_SLOT != below) {
+    nextSlot[slot] = nextSlot[below];
+    nextSlot[below] = slot;
   }
+  else {
+    nextSlot[slot] = firstSlot;
+    firstSlot = slot;
+  }
+  if (NO_SLOT != nextSlot[slot]) {
+    prevSlot[nextSlot[slot]] = slot;
+  }
+  else lastSlot = slot;
+  zOrderChanged = true;
+}
+
+void LEDClusterController::unlinkSlot(const uint16_t slot) {
+  if (NO_SLOT != prevSlot[slot]) {
+    nextSlot[prevSlot[slot]] = nextSlot[slot];
+  }
+  else firstSlot = nextSlot[slot];
+  if (NO_SLOT != nextSlot[slot]) {
+    prevSlot[nextSlot[slot]] = prevSlot[slot];
+  }
+  else lastSlot = prevSlot[slot];
+  zOrderChanged = true;
+}
+
+void LEDClusterController::removeSlot(const uint16_t slot) {
+  LEDCluster *cluster = clusters[slot];
+  addDamage(cluster->getShownStart(), cluster->getShownEnd());
+  delete cluster;
+
+  unlinkSlot(slot);
+
+  // remove from span index by moving the last entry, sortSpanIndex() moves it to its place
+  uint16_t lastIndexed = spanIndex[numClusters-1];
+  spanIndex[indexPos[slot]] = lastIndexed;
+  indexPos[lastIndexed] = indexPos[slot];
+
+  // invalidate handles and put slot on free list
+  clusters[slot] = NULL;
+  generations[slot]++;
+  if (0 == generations[slot]) generations[slot] = 1; // 0 would allow INVALID_CLUSTER_HANDLE
+  nextSlot[slot] = freeSlot;
+  prevSlot[slot] = NO_SLOT;
+  freeSlot = slot;
+  numClusters--;
+}
+
+void LEDClusterController::show() {
+  if (!running) return;
+
+  frameTime = millis(); // sample time once per frame
+  STATS(LEDFrameTimer timer(stats.isTimedFrame()));
+  STATS(uint16_t clustersActive = 0);
+  STATS(uint32_t maxSteps = 0L);
 
   /*
-   * display pixels of LED strip
+   * advance all active clusters by the number of update steps elapsed since their last update
    */
-#ifdef USE_DOTSTAR
-  Adafruit_DotStar::show();
-#elif USE_NEOPIXEL
-  Adafruit_NeoPixel::show();
-#else
-#error Either define USE_NEOPIXEL or USE_DOTSTAR
-#endif
+  for (uint16_t slot=firstSlot; slot!=NO_SLOT; slot=nextSlot[slot]) {
+    LEDCluster *cluster = clusters[slot];
+    if (!cluster->isStarted(frameTime)) continue;
+    STATS(clustersActive++);
+
+    if (cluster->isSmooth()) {
+      cluster->glide(numPixels(), frameTime); // by fractions of pixels, independent of update interval
+      if (cluster->isDone() || !cluster->isStarted(frameTime)) continue;
+    }
+
+    uint32_t steps = cluster->getElapsedSteps(frameTime);
+    if (steps == 0L) continue;
+    STATS(if (steps > maxSteps) maxSteps = steps);
+    if (steps > numPixels()) steps = numPixels(); // limit catch-up to one run over the LED strip
+
+    /*
+     * modify pixels in cluster
+     */
+    cluster->update(steps);
+
+    /*
+     * move cluster
+     */
+    if (cluster->isSmooth()) continue; // moved already
+    for (uint32_t step=0; step<steps; step++) {
+      cluster->step(numPixels(), frameTime);
+      if (cluster->isDone() || !cluster->isStarted(frameTime)) break; // done or restarted
+    }
+  }
+
+  STATS(timer.lap(PhaseUpdate));
 
   /*
    * remove clusters which are done
    */
-  for (uint8_t clusterNo=0; clusterNo<numClusters; clusterNo++) {
-    if (clusters[clusterNo]->isDone()) {
-      Serial << millis() << F(": Cluster #") << clusterNo << F(" done!\n");
-      delete clusters[clusterNo];
-      for (uint8_t idx=clusterNo+1; idx<numClusters; idx++) {
-        clusters[idx-1] = clusters[idx];
+  uint16_t slot = firstSlot;
+  while (NO_SLOT != slot) {
+    uint16_t next = nextSlot[slot]; // before slot gets freed
+    if (clusters[slot]->isDone()) {
+      TRACE(TRACE_SCHEDULE, TRACE_LEVEL_INFO, millis() << F(": Cluster #") << slot << F(" done!\n"));
+      removeSlot(slot);
+    }
+    slot = next;
+  }
+
+  STATS(timer.lap(PhaseRemove));
+
+  /*
+   * collect damaged ranges of LED strip: every cluster which changed its pixels
+   * or its visible span since the last frame damages its old and its new span,
+   * a cluster which changed only some of its pixels in place damages just those
+   */
+  for (slot=firstSlot; slot!=NO_SLOT; slot=nextSlot[slot]) {
+    LEDCluster *cluster = clusters[slot];
+
+    uint16_t firstPixel, endPixel;
+    getVisibleSpan(cluster, firstPixel, endPixel);
+    bool moved = (firstPixel != cluster->getShownStart()) || (endPixel != cluster->getShownEnd());
+    if (!moved && cluster->isPartlyDirty() && (0 == cluster->getCoverage())) {
+      int32_t dirtyStart = cluster->getSpanStart() + cluster->getDirtyStart();
+      int32_t dirtyEnd = cluster->getSpanStart() + cluster->getDirtyEnd();
+      if (dirtyStart < firstPixel) dirtyStart = firstPixel;
+      if (dirtyEnd > endPixel) dirtyEnd = endPixel;
+      if (dirtyStart < dirtyEnd) addDamage(dirtyStart, dirtyEnd);
+      cluster->setShownSpan(firstPixel, endPixel);
+    }
+    else if (moved || cluster->isDirty()) {
+      addDamage(cluster->getShownStart(), cluster->getShownEnd());
+      addDamage(firstPixel, endPixel);
+      cluster->setShownSpan(firstPixel, endPixel);
+    }
+  }
+
+  if (numDamaged > 0) {
+    composeDamage();
+
+    /*
+     * keep the current of the LED strip within the power budget; as a new brightness
+     * rescales the pixels lossy, repaint the whole LED strip with the new brightness
+     */
+    if (limitPower()) {
+      addDamage(0, numPixels());
+      composeDamage();
+    }
+    STATS(timer.lap(PhaseCompose));
+
+    /*
+     * display pixels of LED strip
+     */
+    strip.show();
+    STATS(timer.lap(PhaseShow));
+  }
+  else if (strip.needsRefresh()) { // e.g. temporal dithering
+    STATS(timer.lap(PhaseCompose));
+    strip.show();
+    STATS(timer.lap(PhaseShow));
+  }
+  else return; // no frame, not counted by the statistics
+
+  STATS(stats.addFrame(timer));
+  STATS(stats.setClustersActive(clustersActive));
+  STATS(if (maxSteps > 1L) stats.addDroppedFrames(maxSteps - 1L));
+  STATS(stats.addWireMicros(strip.getWireMicros()));
+}
+
+void LEDClusterController::composeDamage() {
+  /*
+   * clear damaged ranges of LED strip
+   */
+  for (uint8_t rangeNo=0; rangeNo<numDamaged; rangeNo++) {
+    strip.fill(COLOR_BLACK, damageStart[rangeNo], damageEnd[rangeNo]-damageStart[rangeNo]);
+    STATS(stats.addPixelsWritten(damageEnd[rangeNo]-damageStart[rangeNo]));
+  }
+
+  /*
+   * repaint damaged ranges with pixels of the clusters covering them
+   */
+  sortSpanIndex();
+  rankZOrder();
+  for (uint8_t rangeNo=0; rangeNo<numDamaged; rangeNo++) {
+    composeRange(damageStart[rangeNo], damageEnd[rangeNo]);
+  }
+  numDamaged = 0;
+}
+
+uint32_t LEDClusterController::estimateCurrent() const {
+  uint32_t current = (uint32_t)MILLIAMPS_IDLE * numPixels();
+  current += (strip.getIntensity(0) * MILLIAMPS_RED + strip.getIntensity(1) * MILLIAMPS_GREEN + strip.getIntensity(2) * MILLIAMPS_BLUE) / 255;
+  return current;
+}
+
+uint8_t LEDClusterController::getAllowedBrightness(const uint8_t wanted) const {
+  if (0 == powerBudget) return wanted;
+
+  // current of the colors scales with the brightness, the idle current does not
+  uint32_t idleCurrent = (uint32_t)MILLIAMPS_IDLE * numPixels();
+  uint32_t colorBudget = (powerBudget > idleCurrent) ? powerBudget - idleCurrent : 0L;
+  uint32_t colorCurrent = estimateCurrent() - idleCurrent;
+  uint32_t wantedCurrent = colorCurrent * (wanted + 1L) / (strip.getBrightness() + 1L);
+  if (wantedCurrent <= colorBudget) return wanted;
+
+  uint32_t allowed = (wanted + 1L) * colorBudget / wantedCurrent;
+  return (allowed > 0L) ? allowed - 1 : 0;
+}
+
+bool LEDClusterController::limitPower() {
+  uint8_t allowed = getAllowedBrightness(brightness);
+  if (allowed != strip.getBrightness()) {
+    strip.setBrightness(allowed);
+    return true;
+  }
+  else return false;
+}
+
+void LEDClusterController::sortSpanIndex() {
+  // insertion sort, almost linear for an almost sorted index
+  maxSpanLength = 0;
+  numLongSpans = 0;
+  for (uint16_t idx=0; idx<numClusters; idx++) {
+    uint16_t slot = spanIndex[idx];
+    int32_t spanStart = clusters[slot]->getSpanStart();
+    int32_t spanLength = clusters[slot]->getSpanEnd() - spanStart;
+    if (spanLength > LONG_SPAN_LENGTH) {
+      longSpans[numLongSpans++] = slot;
+    }
+    else if (spanLength > maxSpanLength) maxSpanLength = spanLength;
+
+    uint16_t pos = idx;
+    while ((pos > 0) && (clusters[spanIndex[pos-1]]->getSpanStart() > spanStart)) {
+      spanIndex[pos] = spanIndex[pos-1];
+      indexPos[spanIndex[pos]] = pos;
+      pos--;
+    }
+    spanIndex[pos] = slot;
+    indexPos[slot] = pos;
+  }
+}
+
+void LEDClusterController::rankZOrder() {
+  if (!zOrderChanged) return;
+
+  uint16_t rank = 0;
+  for (uint16_t slot=firstSlot; slot!=NO_SLOT; slot=nextSlot[slot]) {
+    zRank[slot] = rank++;
+  }
+  zOrderChanged = false;
+}
+
+void LEDClusterController::composeRange(const uint16_t rangeStart, const uint16_t rangeEnd) {
+  // first cluster with a short span, which may reach into the range: span start >= rangeStart - maxSpanLength
+  int32_t lowestStart = (int32_t)rangeStart - maxSpanLength;
+  uint16_t low = 0;
+  uint16_t high = numClusters;
+  while (low < high) {
+    uint16_t mid = (low + high) / 2;
+    if (clusters[spanIndex[mid]]->getSpanStart() < lowestStart) {
+      low = mid + 1;
+    }
+    else high = mid;
+  }
+
+  // collect clusters covering the range in z-order: long spans starting before lowestStart,
+  // then all spans starting from lowestStart on
+  uint16_t numCovering = 0;
+  for (uint16_t longNo=0; longNo<numLongSpans; longNo++) {
+    uint16_t slot = longSpans[longNo];
+    if (clusters[slot]->getSpanStart() < lowestStart) {
+      addCovering(slot, rangeStart, rangeEnd, numCovering);
+    }
+  }
+  for (uint16_t idx=low; idx<numClusters; idx++) {
+    uint16_t slot = spanIndex[idx];
+    if (clusters[slot]->getSpanStart() >= rangeEnd) break; // all following clusters start behind the range
+    addCovering(slot, rangeStart, rangeEnd, numCovering);
+  }
+
+  // compose from bottom to top
+  for (uint16_t coverNo=0; coverNo<numCovering; coverNo++) {
+    LEDCluster *cluster = clusters[covering[coverNo]];
+    uint16_t firstPixel, endPixel;
+    getVisibleSpan(cluster, firstPixel, endPixel);
+    firstPixel = max(firstPixel, rangeStart);
+    endPixel = min(endPixel, rangeEnd);
+
+    /*
+     * a cluster at a sub-pixel position covers its first pixel partially and the pixel
+     * behind its pixels by its coverage: anti-alias both edge pixels with the pixels below
+     */
+    uint8_t coverage = cluster->getCoverage();
+    int32_t pixelsEnd = cluster->getPixelsEnd();
+    bool smoothFirst = (coverage > 0) && (cluster->getSpanStart() == firstPixel) && (pixelsEnd > firstPixel);
+    bool smoothLast = (coverage > 0) && (pixelsEnd >= firstPixel) && (pixelsEnd < endPixel);
+    uint32_t belowFirst = smoothFirst ? strip.getPixelColor(firstPixel) : 0L;
+    uint32_t belowLast = smoothLast ? strip.getPixelColor(pixelsEnd) : 0L;
+    uint16_t renderEnd = smoothLast ? pixelsEnd : endPixel;
+
+    if (BlendReplace == cluster->getBlendMode()) {
+      cluster->render(strip, firstPixel, renderEnd);
+    }
+    else {
+      LEDBlendSink blendSink(strip, cluster->getBlendMode());
+      cluster->render(blendSink, firstPixel, renderEnd);
+    }
+
+    if (smoothFirst) {
+      strip.setPixelColor(firstPixel, LEDBlendSink::mix(belowFirst, strip.getPixelColor(firstPixel), 255 - coverage));
+    }
+    if (smoothLast) {
+      uint32_t color = LEDBlendSink::blend(cluster->getBlendMode(), belowLast, cluster->getColor(cluster->getLength()-1));
+      strip.setPixelColor(pixelsEnd, LEDBlendSink::mix(belowLast, color, coverage));
+    }
+  }
+}
+
+void LEDClusterController::addCovering(const uint16_t slot, const uint16_t rangeStart, const uint16_t rangeEnd, uint16_t &numCovering) {
+  uint16_t firstPixel, endPixel;
+  getVisibleSpan(clusters[slot], firstPixel, endPixel);
+  if ((firstPixel < rangeEnd) && (endPixel > rangeStart)) { // insert in z-order
+    uint16_t pos = numCovering++;
+    while ((pos > 0) && (zRank[covering[pos-1]] > zRank[slot])) {
+      covering[pos] = covering[pos-1];
+      pos--;
+    }
+    covering[pos] = slot;
+  }
+}
+
+
+
+uint32_t LEDClusterController::getIdleTime() const {
+  if (strip.needsRefresh()) return 0L;  // show every frame
+
+  uint32_t idleTime = 0xffffffffL;
+  for (uint16_t slot=firstSlot; slot!=NO_SLOT; slot=nextSlot[slot]) {
+    LEDCluster *cluster = clusters[slot];
+    int32_t dueTime;
+    if (!cluster->isStarted(frameTime)) {
+      dueTime = cluster->getStartTime() - millis();
+    }
+    else if (cluster->isSmooth()) {
+      dueTime = cluster->getNextMotion() - millis();
+      if (cluster->isAnimated() && ((int32_t)(cluster->getNextUpdate() - millis()) < dueTime)) {
+        dueTime = cluster->getNextUpdate() - millis();
       }
-      numClusters--;
-      clusters[numClusters] = NULL;
     }
+    else if (cluster->isAnimated()) {
+      dueTime = cluster->getNextUpdate() - millis();
+    }
+    else continue; // static cluster
+
+    if (dueTime <= 0L) return 0L;
+    if ((uint32_t)dueTime < idleTime) idleTime = dueTime;
   }
+  return idleTime;
 }
 
-void LEDClusterController::flashAll(const uint32_t color) const {
-  SEROUT(millis() << F(": flashAll color = 0x") << toHexString(color) << LF);
-#ifdef USE_DOTSTAR
-  uint8_t oldBrightness = Adafruit_DotStar::getBrightness();
-  Adafruit_DotStar::setBrightness(255); // max
-  Adafruit_DotStar::fill(color, 0, numPixels());
-  Adafruit_DotStar::show();
-  delay(50);
-  Adafruit_DotStar::setBrightness(oldBrightness);
-  Adafruit_DotStar::clear();
-  Adafruit_DotStar::show();
-#elif USE_NEOPIXEL
-  uint8_t oldBrightness = Adafruit_NeoPixel::getBrightness();
-  Adafruit_NeoPixel::setBrightness(255); // max
-  Adafruit_NeoPixel::fill(color, 0, numPixels());
-  Adafruit_NeoPixel::show();
+
+void LEDClusterController::getVisibleSpan(const LEDCluster *cluster, uint16_t &firstPixel, uint16_t &endPixel) const {
+  int32_t spanStart = cluster->getSpanStart();
+  int32_t spanEnd = cluster->getSpanEnd();
+  if (!cluster->isStarted(frameTime) || (spanEnd <= 0L) || (spanStart >= numPixels())) {
+    firstPixel = endPixel = 0; // nothing visible
+    return;
+  }
+  firstPixel = (spanStart < 0L) ? 0 : spanStart;
+  endPixel = (spanEnd > numPixels()) ? numPixels() : spanEnd;
+}
+
+void LEDClusterController::addDamage(const uint16_t firstPixel, const uint16_t endPixel) {
+  if (firstPixel >= endPixel) return; // empty range
+
+  uint16_t first = firstPixel;
+  uint16_t end = endPixel;
+
+  // merge with all overlapping or adjacent ranges
+  uint8_t rangeNo = 0;
+  while (rangeNo < numDamaged) {
+    if ((first <= damageEnd[rangeNo]) && (damageStart[rangeNo] <= end)) {
+      first = min(first, damageStart[rangeNo]);
+      end = max(end, damageEnd[rangeNo]);
+      numDamaged--;
+      damageStart[rangeNo] = damageStart[numDamaged];
+      damageEnd[rangeNo] = damageEnd[numDamaged];
+    }
+    else rangeNo++;
+  }
+
+  if (numDamaged >= MAX_DAMAGED_RANGES) {
+    // no more room, merge with the range with the smallest gap
+    uint8_t nearestNo = 0;
+    uint16_t nearestGap = 0xffff;
+    for (rangeNo=0; rangeNo<numDamaged; rangeNo++) {
+      uint16_t gap = (damageEnd[rangeNo] < first) ? first - damageEnd[rangeNo] : damageStart[rangeNo] - end;
+      if (gap < nearestGap) {
+        nearestGap = gap;
+        nearestNo = rangeNo;
+      }
+    }
+    first = min(first, damageStart[nearestNo]);
+    end = max(end, damageEnd[nearestNo]);
+    numDamaged--;
+    damageStart[nearestNo] = damageStart[numDamaged];
+    damageEnd[nearestNo] = damageEnd[numDamaged];
+  }
+
+  damageStart[numDamaged] = first;
+  damageEnd[numDamaged] = end;
+  numDamaged++;
+}
+
+void LEDClusterController::flashAll(const uint32_t color) {
+  TRACE(TRACE_SCHEDULE, TRACE_LEVEL_DEBUG, millis() << F(": flashAll color = 0x") << toHexString(color) << LF);
+  uint8_t oldBrightness = strip.getBrightness();
+  strip.setBrightness(255); // max
+  strip.fill(color, 0, numPixels());
+  strip.setBrightness(getAllowedBrightness(255)); // but within power budget
+  strip.show();
   delay(50);
-  Adafruit_NeoPixel::setBrightness(oldBrightness);
-  Adafruit_NeoPixel::clear();
-  Adafruit_NeoPixel::show();
-#else
-#error Either define USE_NEOPIXEL or USE_DOTSTAR
-#endif
+  strip.setBrightness(oldBrightness);
+  strip.clear();
+  strip.show();
+
+  addDamage(0, numPixels()); // repaint whole LED strip with next frame
 }
@@ -1,10 +1,6 @@
 // NAME: LEDClusterController.h
 //
-// DESC: Control a group of LEDClusters and animate their behavior on an Adafruit_DotStar LED strip.
-//
-// DEPENDENCIES:
-//  Adafruit_DotStar library from https://github.com/adafruit/Adafruit_DotStar
-//  Adafruit_NeoPixel library from https://github.com/adafruit/Adafruit_NeoPixel
+// DESC: Control a group of LEDClusters and animate their behavior on an LED strip.
 //
 // Copyright (c) 2020-21 by Andreas Trappmann
 // All rights reserved.
@@ -14,46 +10,126 @@
 
 #include <Arduino.h>
 #include "LEDStripTest.h"
+#include "LEDClusterArena.h"
+#include "LEDFrameStats.h"
+#include "LEDPixelSink.h"
 
 class LEDCluster;
 typedef LEDCluster*  LEDClusterPtr;
 
-class LEDClusterController : public 
-#ifdef USE_DOTSTAR
-  Adafruit_DotStar
-#elif USE_NEOPIXEL
-  Adafruit_NeoPixel
-#else
-#error Either define USE_NEOPIXEL or USE_DOTSTAR
-#endif
-{
+/*
+ * stable handle of a cluster added to LEDClusterController: generation in the high word, slot in the low word.
+ * A handle becomes invalid, when its cluster is removed, even if the slot gets reused.
+ */
+typedef uint32_t LEDClusterHandle;
+#define INVALID_CLUSTER_HANDLE  ((LEDClusterHandle)0)
+
+#define NO_SLOT             0xffff  // end of lists of slots
+#define MAX_DAMAGED_RANGES  4   // maximum number of separately repainted ranges of the LED strip per frame
+#define LONG_SPAN_LENGTH    64  // clusters with longer spans are kept in a list of their own for composition
+
+class LEDClusterController {
 private:
-  uint8_t       maxClusters;  // maximum number of controlled LEDClusters
-  LEDClusterPtr *clusters;    // array of pointers to LEDClusters
-  
-  uint8_t       numClusters;
+  LEDPixelSink  &strip;       // output for the pixels of the LED strip
+  uint16_t      maxClusters;  // maximum number of controlled LEDClusters
+  LEDClusterArena arena;      // memory for LEDClusters and their pixels
+
+  /*
+   * registry of clusters: slots are linked in z-order (first slot is shown at the bottom),
+   * free slots are linked in a free list via nextSlot
+   */
+  LEDClusterPtr *clusters;    // cluster per slot, NULL if slot is free
+  uint16_t      *generations; // generation per slot, incremented when the slot is freed
+  uint16_t      *nextSlot;    // next slot in z-order or in free list
+  uint16_t      *prevSlot;    // previous slot in z-order
+  uint16_t      firstSlot;    // bottom of z-order
+  uint16_t      lastSlot;     // top of z-order
+  uint16_t      freeSlot;     // head of free list
+  uint16_t      numClusters;
+
+  /*
+   * sweep-line index for composition: slots sorted by span start, kept sorted incrementally,
+   * as clusters move only a few pixels per frame. A range looks back in the index by the
+   * longest short span only; clusters with spans longer than LONG_SPAN_LENGTH, e.g. the
+   * background of a scene or LEDStreamCluster, are checked in the list of long spans.
+   */
+  uint16_t      *spanIndex;   // slots sorted by span start
+  uint16_t      *indexPos;    // position of slot in spanIndex
+  int32_t       maxSpanLength; // longest span of all clusters with a span up to LONG_SPAN_LENGTH
+  uint16_t      *longSpans;   // slots of clusters with a span longer than LONG_SPAN_LENGTH
+  uint16_t      numLongSpans;
+  uint16_t      *zRank;       // rank of slot in z-order, see rankZOrder()
+  bool          zOrderChanged;
+  uint16_t      *covering;    // slots covering the range being composed
   bool          running;
-  
-public:
-#ifdef USE_DOTSTAR
-  LEDClusterController(const uint16_t numLEDs, const uint8_t ledConfig, const uint8_t maxClusters);
-  LEDClusterController(const uint16_t numLEDs, const uint8_t dataPin, const uint8_t clockPin, const uint8_t ledConfig, const uint8_t maxClusters);
-#elif USE_NEOPIXEL
-  LEDClusterController(const uint16_t numLEDs, const uint8_t dataPin, const uint8_t ledConfig, const uint8_t maxClusters);
-#else
-#error Either define USE_NEOPIXEL or USE_DOTSTAR
+  uint32_t      frameTime;    // time of current frame in milliseconds, sampled once per frame
+  uint8_t       brightness;   // brightness of the LED strip, as long as within power budget
+  uint16_t      powerBudget;  // maximum current of the LED strip in mA, 0 for unlimited
+#ifdef USE_FRAME_STATS
+  LEDFrameStats stats;        // timing and counters of the frames shown
 #endif
 
+  /*
+   * ranges [damageStart, damageEnd) of the LED strip, which must be repainted with the next frame
+   */
+  uint8_t       numDamaged;
+  uint16_t      damageStart[MAX_DAMAGED_RANGES];
+  uint16_t      damageEnd[MAX_DAMAGED_RANGES];
+
+  uint16_t getSlot(const LEDClusterHandle handle) const;
+  void linkSlot(const uint16_t slot);
+  void unlinkSlot(const uint16_t slot);
+  void removeSlot(const uint16_t slot);
+  bool addSceneCluster(LEDCluster *cluster, const int16_t position);
+
+  void composeDamage();
+  uint8_t getAllowedBrightness(const uint8_t wanted) const;
+  bool limitPower();
+
+  void sortSpanIndex();
+  void rankZOrder();
+  void composeRange(const uint16_t rangeStart, const uint16_t rangeEnd);
+  void addCovering(const uint16_t slot, const uint16_t rangeStart, const uint16_t rangeEnd, uint16_t &numCovering);
+
+  void getVisibleSpan(const LEDCluster *cluster, uint16_t &firstPixel, uint16_t &endPixel) const;
+  void addDamage(const uint16_t firstPixel, const uint16_t endPixel);
+
+public:
+  LEDClusterController(LEDPixelSink &strip, const uint16_t maxClusters, const uint16_t arenaSize);
+
   ~LEDClusterController();
   
   void begin();
   void end();
   
-  bool addCluster(const LEDCluster *cluster, const int32_t position = 0);
+  LEDClusterHandle addCluster(LEDCluster *cluster, const int32_t position = 0); // INVALID_CLUSTER_HANDLE on failure
+  bool removeCluster(const LEDClusterHandle handle);  // deletes the cluster
+  LEDCluster *getCluster(const LEDClusterHandle handle) const;  // NULL, if cluster was removed
+  uint16_t getNumClusters() const { return numClusters; }
+  bool setLayer(const LEDClusterHandle handle, const uint8_t layer);  // moves cluster in z-order
+  uint16_t loadScene(const uint8_t *scene); // scene in PROGMEM, see LEDScene.h; returns number of clusters added
 
   void show();
+  uint32_t getIdleTime() const;   // milliseconds until the next cluster is due for an update
+
+  void flashAll(const uint32_t color);
 
-  void flashAll(const uint32_t color) const;
+  /*
+   * power budget: the brightness is reduced automatically, if the current estimated from the
+   * pixels with the power model in LEDStripTest.h would exceed the budget
+   */
+  void setBrightness(const uint8_t brightness);
+  uint8_t getBrightness() const { return brightness; }
+  void setPowerBudget(const uint16_t milliAmps);  // 0 for unlimited
+  uint16_t getPowerBudget() const { return powerBudget; }
+  uint32_t estimateCurrent() const;   // current in mA of the pixels in the LED strip
+
+  const LEDClusterArena &getArena() const { return arena; }
+  LEDPixelSink &getStrip() const { return strip; }
+#ifdef USE_FRAME_STATS
+  LEDFrameStats &getStats() { return stats; }
+#endif
+  uint16_t numPixels() const { return strip.numPixels(); }
 
 };
 
@@ -0,0 +1,22 @@
+// NAME: LEDColor.h
+//
+// DESC: Conversion of HSV colors into gamma corrected RGB colors for the LED strip.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDCOLOR_H
+#define LEDCOLOR_H
+
+#include <Arduino.h>
+#include "LEDStripTest.h"
+
+/*
+ * Returns the gamma corrected RGB color of hue, saturation and value (full value by default).
+ * Depending on HSV_TABLE_STEPS in LEDStripTest.h, the color is either calculated
+ * with ColorHSV() and gamma32() of the Adafruit library or looked up in a table
+ * of fully saturated colors in PROGMEM.
+ */
+uint32_t gammaColorHSV(const uint16_t hue, const uint8_t saturation = 255, const uint8_t value = 255);
+
+#endif /* LEDCOLOR_H */
@@ -0,0 +1,82 @@
+// NAME: LEDDotStarSink.cpp
+//
+// DESC: LEDPixelSink for APA102 smart pixel strips driven by the Adafruit_DotStar library.
+//
+// DEPENDENCIES:
+//  Adafruit_DotStar library from https://github.com/adafruit/Adafruit_DotStar
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDDotStarSink.h"
+#include "LEDSpanKernels.h"
+
+#ifdef USE_DOTSTAR
+
+LEDDotStarSink::LEDDotStarSink(const uint16_t numLEDs, const uint8_t ledConfig)
+               :strip(numLEDs, ledConfig) {
+  setOffsets(ledConfig);
+  setWireMicros(DOTSTAR_SPI_CLOCK);
+}
+
+LEDDotStarSink::LEDDotStarSink(const uint16_t numLEDs, const uint8_t dataPin, const uint8_t clockPin, const uint8_t ledConfig)
+               :strip(numLEDs, dataPin, clockPin, ledConfig) {
+  setOffsets(ledConfig);
+  setWireMicros(DOTSTAR_BITBANG_CLOCK);
+}
+
+void LEDDotStarSink::setOffsets(const uint8_t ledConfig) {
+  // same decoding of the color order as the constructor of Adafruit_DotStar
+  rOffset = ledConfig & 3;
+  gOffset = (ledConfig >> 2) & 3;
+  bOffset = (ledConfig >> 4) & 3;
+}
+
+void LEDDotStarSink::setWireMicros(const uint32_t clockRate) {
+  uint32_t bits = 32 + 32L * numPixels() + 8 * ((numPixels() + 15) / 16);
+  wireMicros = (bits * 1000L) / (clockRate / 1000L);
+}
+
+uint32_t LEDDotStarSink::getStoredColor(const uint16_t pixelNo) const {
+  const uint8_t *pixel = strip.getPixels() + (uint32_t)pixelNo * 3;
+  return ((uint32_t)pixel[rOffset] << 16) | ((uint32_t)pixel[gOffset] << 8) | pixel[bOffset];
+}
+
+void LEDDotStarSink::setPixelColor(const uint16_t pixelNo, const uint32_t color) {
+  if (pixelNo >= numPixels()) return;
+  subIntensity(getStoredColor(pixelNo));
+  strip.setPixelColor(pixelNo, color);
+  addIntensity(getStoredColor(pixelNo));
+}
+
+void LEDDotStarSink::fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count) {
+  if ((0 == count) || (firstPixel >= numPixels())) return; // Adafruit_DotStar::fill() would fill up to the end of the strip
+  uint16_t endPixel = ((uint32_t)firstPixel + count > numPixels()) ? numPixels() : firstPixel + count;
+  for (uint16_t pixelNo=firstPixel; pixelNo<endPixel; pixelNo++) {
+    subIntensity(getStoredColor(pixelNo));
+  }
+  strip.fill(color, firstPixel, endPixel - firstPixel);
+  addIntensity(getStoredColor(firstPixel), endPixel - firstPixel);
+}
+
+/*
+ * write into the pixel buffer of Adafruit_DotStar like its setPixelColor(), but a whole span at once:
+ * unscaled, Adafruit_DotStar applies the brightness in show()
+ */
+void LEDDotStarSink::writePixels(const uint16_t firstPixel, const uint8_t *pixels, const uint16_t count) {
+  if ((0 == count) || (firstPixel >= numPixels())) return;
+  uint16_t endPixel = ((uint32_t)firstPixel + count > numPixels()) ? numPixels() : firstPixel + count;
+  uint8_t *wire = strip.getPixels() + (uint32_t)firstPixel * 3;
+  uint32_t before[3] = { 0L, 0L, 0L };
+  uint32_t after[3] = { 0L, 0L, 0L };
+  spanIntensity(wire, endPixel - firstPixel, before);
+  spanSwizzle(wire, pixels, rOffset, gOffset, bOffset, endPixel - firstPixel);
+  spanIntensity(wire, endPixel - firstPixel, after);
+  changeIntensity(before, after, rOffset, gOffset, bOffset);
+}
+
+void LEDDotStarSink::setBrightness(const uint8_t brightness) {
+  strip.setBrightness(brightness);  // applied in show(), the pixels and their intensity stay unscaled
+}
+
+#endif /* USE_DOTSTAR */
@@ -0,0 +1,66 @@
+// NAME: LEDDotStarSink.h
+//
+// DESC: LEDPixelSink for APA102 smart pixel strips driven by the Adafruit_DotStar library.
+//
+// DEPENDENCIES:
+//  Adafruit_DotStar library from https://github.com/adafruit/Adafruit_DotStar
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDDOTSTARSINK_H
+#define LEDDOTSTARSINK_H
+
+#include "LEDStripTest.h"
+
+#ifdef USE_DOTSTAR
+
+#include <Adafruit_DotStar.h>
+#include "LEDPixelSink.h"
+
+/*
+ * clock rates for getWireMicros(): Adafruit_DotStar sets hardware SPI to 8 MHz, bit banged
+ * SPI is a rough estimate; every frame has a start frame of 32 bits, 32 bits per pixel and
+ * an end frame of half a bit per pixel
+ */
+#define DOTSTAR_SPI_CLOCK       8000000L
+#define DOTSTAR_BITBANG_CLOCK   1000000L
+
+class LEDDotStarSink : public LEDPixelSink {
+private:
+  Adafruit_DotStar strip;
+  uint8_t   rOffset;          // layout of pixels in Adafruit_DotStar::getPixels()
+  uint8_t   gOffset;
+  uint8_t   bOffset;
+  uint32_t  wireMicros;       // time of show() on the wire
+
+  void setOffsets(const uint8_t ledConfig);
+  void setWireMicros(const uint32_t clockRate);
+  uint32_t getStoredColor(const uint16_t pixelNo) const; // color without brightness, see getIntensity()
+
+public:
+  LEDDotStarSink(const uint16_t numLEDs, const uint8_t ledConfig);  // hardware SPI
+  LEDDotStarSink(const uint16_t numLEDs, const uint8_t dataPin, const uint8_t clockPin, const uint8_t ledConfig);
+
+  virtual void begin()    { strip.begin(); }
+  virtual void show()     { strip.show(); }
+  virtual bool canShow()  { return true; }  // show() does not wait for a latch time
+  virtual uint32_t getWireMicros() const { return wireMicros; }
+
+  virtual uint16_t numPixels() const { return strip.numPixels(); }
+
+  virtual void setPixelColor(const uint16_t pixelNo, const uint32_t color);
+  virtual uint32_t getPixelColor(const uint16_t pixelNo) const { return strip.getPixelColor(pixelNo); }
+  virtual void fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count);
+  virtual void writePixels(const uint16_t firstPixel, const uint8_t *pixels, const uint16_t count);
+
+  virtual void setBrightness(const uint8_t brightness);
+  virtual uint8_t getBrightness() const { return strip.getBrightness(); }
+
+  // Adafruit_DotStar keeps the pixels unscaled and applies the brightness in show()
+  virtual uint32_t getIntensity(const uint8_t channel) const { return (intensity[channel] * (getBrightness() + 1L)) >> 8; }
+};
+
+#endif /* USE_DOTSTAR */
+
+#endif /* LEDDOTSTARSINK_H */
@@ -0,0 +1,159 @@
+// NAME: LEDDoubleBufferSink.cpp
+//
+// DESC: LEDPixelSink rendering into a back buffer in RAM, while the pixels of the previous
+//       frame are transmitted from the front buffer of another LEDPixelSink.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDDoubleBufferSink.h"
+#include "LEDSpanKernels.h"
+
+LEDDoubleBufferSink::LEDDoubleBufferSink(LEDPixelSink &front)
+                    :front(front) {
+  pixels = (uint8_t *)calloc(front.numPixels(), 3);
+  numLEDs = (NULL != pixels) ? front.numPixels() : 0;
+  changedStart = 0;
+  changedEnd = numLEDs;
+  dithering = false;
+  scale = 256;
+  frameNo = 0;
+}
+
+LEDDoubleBufferSink::~LEDDoubleBufferSink() {
+  if (NULL != pixels) free(pixels);
+  pixels = NULL;
+}
+
+void LEDDoubleBufferSink::markChanged(const uint16_t firstPixel, const uint16_t endPixel) {
+  if (changedStart >= changedEnd) { // nothing changed yet
+    changedStart = firstPixel;
+    changedEnd = endPixel;
+  }
+  else {
+    if (firstPixel < changedStart) changedStart = firstPixel;
+    if (endPixel > changedEnd) changedEnd = endPixel;
+  }
+}
+
+void LEDDoubleBufferSink::setBrightness(const uint8_t brightness) {
+  if (dithering) {
+    scale = brightness + 1;
+    markChanged(0, numLEDs);
+  }
+  else front.setBrightness(brightness);
+}
+
+void LEDDoubleBufferSink::setDithering(const bool enable) {
+  if (enable == dithering) return;
+  if (enable) { // take over brightness from front sink
+    scale = front.getBrightness() + 1;
+    front.setBrightness(255);
+  }
+  else {
+    front.setBrightness(scale - 1);
+  }
+  dithering = enable;
+  markChanged(0, numLEDs);
+}
+
+void LEDDoubleBufferSink::show() {
+  front.waitIdle(); // fence: front buffer is still transmitted
+
+  if (dithering) {
+    showDithered();
+    return;
+  }
+
+  // swap: copy changed pixels into front buffer
+  if (changedStart < changedEnd) {
+    front.writePixels(changedStart, &pixels[changedStart * 3], changedEnd - changedStart);
+  }
+  changedStart = changedEnd = 0;
+
+  front.show();
+}
+
+// bit reversed nibbles: consecutive frames get thresholds far apart, e.g. 0, 128, 64, 192...
+static const uint8_t reversedNibble[16] = { 0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15 };
+
+void LEDDoubleBufferSink::showDithered() {
+  if (scale < 256) {
+    /*
+     * Only pixels with a fraction after scaling get a new threshold. The others show the
+     * same value in every frame, they are written only if changed. The dithered pixels
+     * are collected in chunks for the span path of the front sink.
+     */
+    uint8_t chunk[DITHER_CHUNK * 3];
+    uint16_t chunkStart = 0;
+    uint8_t chunkLength = 0;
+    const uint8_t *pixel = pixels;
+    for (uint16_t pixelNo=0; pixelNo<numLEDs; pixelNo++, pixel+=3) {
+      uint16_t red   = (uint16_t)pixel[0] * scale;
+      uint16_t green = (uint16_t)pixel[1] * scale;
+      uint16_t blue  = (uint16_t)pixel[2] * scale;
+      if ((0 == ((red | green | blue) & 0xff)) && ((pixelNo < changedStart) || (pixelNo >= changedEnd))) {
+        if (chunkLength > 0) front.writePixels(chunkStart, chunk, chunkLength);
+        chunkLength = 0;
+        continue;
+      }
+      uint8_t step = frameNo + pixelNo * 37;  // neighboring pixels do not flicker in sync
+      uint8_t threshold = (reversedNibble[step & 0x0f] << 4) | reversedNibble[step >> 4];
+      if (0 == chunkLength) chunkStart = pixelNo;
+      uint8_t *dithered = &chunk[chunkLength * 3];
+      dithered[0] = (red + threshold) >> 8;
+      dithered[1] = (green + threshold) >> 8;
+      dithered[2] = (blue + threshold) >> 8;
+      if (++chunkLength == DITHER_CHUNK) {
+        front.writePixels(chunkStart, chunk, chunkLength);
+        chunkLength = 0;
+      }
+    }
+    if (chunkLength > 0) front.writePixels(chunkStart, chunk, chunkLength);
+    frameNo++;
+  }
+  else if (changedStart < changedEnd) { // full brightness, nothing to dither
+    front.writePixels(changedStart, &pixels[changedStart * 3], changedEnd - changedStart);
+  }
+  changedStart = changedEnd = 0;
+
+  front.show();
+}
+
+void LEDDoubleBufferSink::setPixelColor(const uint16_t pixelNo, const uint32_t color) {
+  if (pixelNo < numLEDs) {
+    subIntensity(getPixelColor(pixelNo));
+    addIntensity(color);
+    uint8_t *pixel = &pixels[pixelNo * 3];
+    pixel[0] = (color >> 16) & 0xff;
+    pixel[1] = (color >> 8) & 0xff;
+    pixel[2] = color & 0xff;
+    markChanged(pixelNo, pixelNo+1);
+  }
+}
+
+uint32_t LEDDoubleBufferSink::getPixelColor(const uint16_t pixelNo) const {
+  if (pixelNo < numLEDs) {
+    const uint8_t *pixel = &pixels[pixelNo * 3];
+    return ((uint32_t)pixel[0] << 16) | ((uint32_t)pixel[1] << 8) | pixel[2];
+  }
+  else return 0L;
+}
+
+void LEDDoubleBufferSink::fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count) {
+  blendFill(BlendReplace, color, firstPixel, count);
+}
+
+bool LEDDoubleBufferSink::blendFill(const BlendMode mode, const uint32_t color, const uint16_t firstPixel, const uint16_t count) {
+  if ((0 == count) || (firstPixel >= numLEDs)) return true;
+  uint16_t endPixel = ((uint32_t)firstPixel + count > numLEDs) ? numLEDs : firstPixel + count;
+  uint8_t *span = &pixels[firstPixel * 3];
+  uint32_t before[3] = { 0L, 0L, 0L };
+  uint32_t after[3] = { 0L, 0L, 0L };
+  spanIntensity(span, endPixel - firstPixel, before);
+  spanBlend(span, mode, color, endPixel - firstPixel);
+  spanIntensity(span, endPixel - firstPixel, after);
+  changeIntensity(before, after);
+  markChanged(firstPixel, endPixel);
+  return true;
+}
@@ -0,0 +1,78 @@
+// NAME: LEDDoubleBufferSink.h
+//
+// DESC: LEDPixelSink rendering into a back buffer in RAM, while the pixels of the previous
+//       frame are transmitted from the front buffer of another LEDPixelSink.
+//
+//       show() waits for the transmission of the previous frame (fence), copies the changed
+//       pixels of the back buffer into the front buffer (swap) and starts the transmission.
+//       If the front sink transmits in the background (isBusy(), e.g. SPI with DMA), the next
+//       frame can be rendered while the LED strip is updated. LEDNeoPixelSink and
+//       LEDDotStarSink block in show() instead, only the host sink LEDThreadSink transmits in
+//       the background so far.
+//
+//       Dithered brightness: if enabled, the brightness is applied here instead of by the
+//       front sink. A pixel, whose scaled color has a fraction, is rounded with a threshold
+//       changing with every frame, so the LED strip shows the fraction averaged over the
+//       frames, which scaling to 8 bits would lose at low brightness. The clusters and the
+//       composition of the frame still have 8 bits per color, only the brightness stage
+//       gains resolution. The dithered pixels are written through the span path of the
+//       front sink, the other pixels only if changed. show() must be called continuously
+//       (needsRefresh()), and a fast refresh rate like APA102 is needed to avoid visible
+//       flicker.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDDOUBLEBUFFERSINK_H
+#define LEDDOUBLEBUFFERSINK_H
+
+#include <Arduino.h>
+#include "LEDPixelSink.h"
+
+#define DITHER_CHUNK  32  // dithered pixels written to the front sink at once
+
+class LEDDoubleBufferSink : public LEDPixelSink {
+private:
+  LEDPixelSink  &front;       // front buffer and transmitter
+  uint16_t      numLEDs;
+  uint8_t       *pixels;      // back buffer with R-G-B triples of all pixels, brightness not applied
+  uint16_t      changedStart; // range [changedStart, changedEnd) of pixels changed since last show()
+  uint16_t      changedEnd;
+
+  bool          dithering;    // flag, if brightness is dithered over the frames
+  uint16_t      scale;        // brightness + 1 while dithering, the front sink has full brightness
+  uint8_t       frameNo;      // changes the dithering threshold of every pixel per frame
+
+  void markChanged(const uint16_t firstPixel, const uint16_t endPixel);
+  void showDithered();
+
+public:
+  LEDDoubleBufferSink(LEDPixelSink &front);
+  virtual ~LEDDoubleBufferSink();
+
+  virtual void begin()    { front.begin(); }
+  virtual void show();
+  virtual bool canShow()  { return front.canShow(); }
+  virtual bool isBusy()   { return front.isBusy(); }
+
+  virtual uint16_t numPixels() const { return numLEDs; }
+
+  virtual void setPixelColor(const uint16_t pixelNo, const uint32_t color);
+  virtual uint32_t getPixelColor(const uint16_t pixelNo) const;
+  virtual void fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count);
+  virtual bool blendFill(const BlendMode mode, const uint32_t color, const uint16_t firstPixel, const uint16_t count);
+
+  virtual bool needsRefresh() { return dithering && (scale < 256); }
+  virtual uint32_t getWireMicros() const { return front.getWireMicros(); }
+
+  virtual void setBrightness(const uint8_t brightness);
+  virtual uint8_t getBrightness() const { return dithering ? scale - 1 : front.getBrightness(); }
+
+  void setDithering(const bool enable);
+  bool isDithering() const  { return dithering; }
+
+  // estimated from back buffer, as the front sink gets the pixels with show() only
+  virtual uint32_t getIntensity(const uint8_t channel) const { return (intensity[channel] * (getBrightness() + 1L)) >> 8; }
+};
+
+#endif /* LEDDOUBLEBUFFERSINK_H */
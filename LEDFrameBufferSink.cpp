@@ -0,0 +1,58 @@
+// NAME: LEDFrameBufferSink.cpp
+//
+// DESC: LEDPixelSink keeping the pixels of an LED strip in memory only, e.g. for
+//       profiling and testing the rendering of LEDClusters without any hardware.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDFrameBufferSink.h"
+#include "LEDSpanKernels.h"
+
+LEDFrameBufferSink::LEDFrameBufferSink(const uint16_t numLEDs) {
+  pixels = (uint8_t *)calloc(numLEDs, 3);
+  this->numLEDs = (NULL != pixels) ? numLEDs : 0;
+  brightness = 255;
+  showCount = 0L;
+}
+
+LEDFrameBufferSink::~LEDFrameBufferSink() {
+  if (NULL != pixels) free(pixels);
+  pixels = NULL;
+}
+
+void LEDFrameBufferSink::setPixelColor(const uint16_t pixelNo, const uint32_t color) {
+  if (pixelNo < numLEDs) {
+    subIntensity(getPixelColor(pixelNo));
+    addIntensity(color);
+    uint8_t *pixel = &pixels[pixelNo * 3];
+    pixel[0] = (color >> 16) & 0xff;
+    pixel[1] = (color >> 8) & 0xff;
+    pixel[2] = color & 0xff;
+  }
+}
+
+uint32_t LEDFrameBufferSink::getPixelColor(const uint16_t pixelNo) const {
+  if (pixelNo < numLEDs) {
+    const uint8_t *pixel = &pixels[pixelNo * 3];
+    return ((uint32_t)pixel[0] << 16) | ((uint32_t)pixel[1] << 8) | pixel[2];
+  }
+  else return 0L;
+}
+
+void LEDFrameBufferSink::fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count) {
+  blendFill(BlendReplace, color, firstPixel, count);
+}
+
+bool LEDFrameBufferSink::blendFill(const BlendMode mode, const uint32_t color, const uint16_t firstPixel, const uint16_t count) {
+  if ((0 == count) || (firstPixel >= numLEDs)) return true;
+  uint16_t endPixel = ((uint32_t)firstPixel + count > numLEDs) ? numLEDs : firstPixel + count;
+  uint8_t *span = &pixels[firstPixel * 3];
+  uint32_t before[3] = { 0L, 0L, 0L };
+  uint32_t after[3] = { 0L, 0L, 0L };
+  spanIntensity(span, endPixel - firstPixel, before);
+  spanBlend(span, mode, color, endPixel - firstPixel);
+  spanIntensity(span, endPixel - firstPixel, after);
+  changeIntensity(before, after);
+  return true;
+}
@@ -0,0 +1,47 @@
+// NAME: LEDFrameBufferSink.h
+//
+// DESC: LEDPixelSink keeping the pixels of an LED strip in memory only, e.g. for
+//       profiling and testing the rendering of LEDClusters without any hardware.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDFRAMEBUFFERSINK_H
+#define LEDFRAMEBUFFERSINK_H
+
+#include <Arduino.h>
+#include "LEDPixelSink.h"
+
+class LEDFrameBufferSink : public LEDPixelSink {
+private:
+  uint16_t  numLEDs;
+  uint8_t   *pixels;        // R-G-B triples of all pixels, brightness not applied
+  uint8_t   brightness;
+  uint32_t  showCount;      // number of calls to show()
+
+public:
+  LEDFrameBufferSink(const uint16_t numLEDs);
+  virtual ~LEDFrameBufferSink();
+
+  virtual void begin()    {}
+  virtual void show()     { showCount++; }
+  virtual bool canShow()  { return true; }
+
+  virtual uint16_t numPixels() const { return numLEDs; }
+
+  virtual void setPixelColor(const uint16_t pixelNo, const uint32_t color);
+  virtual uint32_t getPixelColor(const uint16_t pixelNo) const;
+  virtual void fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count);
+  virtual bool blendFill(const BlendMode mode, const uint32_t color, const uint16_t firstPixel, const uint16_t count);
+
+  virtual void setBrightness(const uint8_t brightness) { this->brightness = brightness; }
+  virtual uint8_t getBrightness() const { return brightness; }
+
+  // estimated like Adafruit_NeoPixel would apply brightness
+  virtual uint32_t getIntensity(const uint8_t channel) const { return (intensity[channel] * (brightness + 1L)) >> 8; }
+
+  const uint8_t *getPixels() const  { return pixels; }
+  uint32_t getShowCount() const     { return showCount; }
+};
+
+#endif /* LEDFRAMEBUFFERSINK_H */
@@ -0,0 +1,58 @@
+// NAME: LEDFrameStats.cpp
+//
+// DESC: Statistics of the frames shown by LEDClusterController: timing of each phase
+//       of show(), pixels written, clusters active, dropped frames and time on the wire.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <TrappmannRobotics.h>
+
+#include "LEDFrameStats.h"
+
+LEDFrameStats::LEDFrameStats() {
+  reset();
+}
+
+void LEDFrameStats::reset() {
+  frames = 0L;
+  timedFrames = 0L;
+  for (uint8_t phase=0; phase<NUM_FRAME_PHASES; phase++) {
+    minMicros[phase] = 0xffffffffL;
+    maxMicros[phase] = 0L;
+    sumMicros[phase] = 0L;
+  }
+  pixelsWritten = 0L;
+  clustersActive = 0;
+  droppedFrames = 0L;
+  sumWireMicros = 0L;
+}
+
+void LEDFrameStats::addFrame(const LEDFrameTimer &timer) {
+  frames++;
+  if (!timer.isTimed()) return;
+
+  timedFrames++;
+  for (uint8_t phase=0; phase<NUM_FRAME_PHASES; phase++) {
+    uint32_t micros = timer.phaseMicros[phase];
+    if (micros < minMicros[phase]) minMicros[phase] = micros;
+    if (micros > maxMicros[phase]) maxMicros[phase] = micros;
+    sumMicros[phase] += micros;
+  }
+}
+
+void LEDFrameStats::printCSVHeader() {
+  Serial << F("frames,timed,update_min,update_max,update_mean,remove_min,remove_max,remove_mean,")
+         << F("compose_min,compose_max,compose_mean,show_min,show_max,show_mean,")
+         << F("pixels,clusters,dropped,wire_mean\n");
+}
+
+void LEDFrameStats::printCSV() const {
+  Serial << frames << ',' << timedFrames;
+  for (uint8_t phase=0; phase<NUM_FRAME_PHASES; phase++) {
+    Serial << ',' << getMinMicros((LEDFramePhase)phase)
+           << ',' << getMaxMicros((LEDFramePhase)phase)
+           << ',' << getMeanMicros((LEDFramePhase)phase);
+  }
+  Serial << ',' << pixelsWritten << ',' << clustersActive << ',' << droppedFrames << ',' << getMeanWireMicros() << LF;
+}
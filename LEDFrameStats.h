@@ -0,0 +1,103 @@
+// NAME: LEDFrameStats.h
+//
+// DESC: Statistics of the frames shown by LEDClusterController: timing of each phase
+//       of show(), pixels written, clusters active, dropped frames and the time on the wire
+//       estimated by the LEDPixelSink, see LEDPixelSink::getWireMicros().
+//
+//       Only calls of show(), which compose or transmit a frame, are counted. To keep the
+//       calls of micros() out of most frames, the phases are timed every STATS_TIMED_FRAMES
+//       frames only; min, max and mean are taken over the timed frames.
+//
+//       The statistics are compiled in only, if USE_FRAME_STATS is defined in LEDStripTest.h.
+//       Otherwise the STATS() macro removes all measurements from LEDClusterController.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDFRAMESTATS_H
+#define LEDFRAMESTATS_H
+
+#include <Arduino.h>
+#include "LEDStripTest.h"
+
+#ifdef USE_FRAME_STATS
+#define STATS(stmt) stmt
+#else
+#define STATS(stmt)
+#endif
+
+#define STATS_TIMED_FRAMES  16  // every 16th frame is timed
+
+enum LEDFramePhase {
+  PhaseUpdate,    // update and move clusters
+  PhaseRemove,    // remove clusters which are done
+  PhaseCompose,   // collect damage and repaint damaged ranges
+  PhaseShow,      // transmit pixels to the LED strip
+  NUM_FRAME_PHASES
+};
+
+/*
+ * durations of the phases of one call of show(), measured only if the frame is timed
+ */
+class LEDFrameTimer {
+private:
+  bool      timed;
+  uint32_t  lapStart;                         // end of the previous phase in microseconds
+
+public:
+  uint32_t  phaseMicros[NUM_FRAME_PHASES];
+
+  LEDFrameTimer(const bool timed) { this->timed = timed; lapStart = timed ? micros() : 0L; }
+
+  bool isTimed() const { return timed; }
+  void lap(const LEDFramePhase phase) {
+    if (timed) {
+      uint32_t now = micros();
+      phaseMicros[phase] = now - lapStart;
+      lapStart = now;
+    }
+  }
+};
+
+class LEDFrameStats {
+private:
+  uint32_t  frames;                           // number of frames composed or transmitted
+  uint32_t  timedFrames;                      // number of frames with timed phases
+  uint32_t  minMicros[NUM_FRAME_PHASES];      // shortest duration of phase
+  uint32_t  maxMicros[NUM_FRAME_PHASES];      // longest duration of phase
+  uint32_t  sumMicros[NUM_FRAME_PHASES];      // sum of durations of phase for the mean
+  uint32_t  pixelsWritten;                    // pixels repainted in all frames
+  uint16_t  clustersActive;                   // active clusters in the last frame
+  uint32_t  droppedFrames;                    // update steps caught up in a later frame
+  uint32_t  sumWireMicros;                    // estimated time on the wire of all frames
+
+public:
+  LEDFrameStats();
+
+  void reset();
+
+  bool isTimedFrame() const { return 0L == frames % STATS_TIMED_FRAMES; } // next frame is timed
+  void addFrame(const LEDFrameTimer &timer);
+  void addPixelsWritten(const uint16_t pixels)  { pixelsWritten += pixels; }
+  void setClustersActive(const uint16_t clusters) { clustersActive = clusters; }
+  void addDroppedFrames(const uint32_t dropped) { droppedFrames += dropped; }
+  void addWireMicros(const uint32_t micros)     { sumWireMicros += micros; }
+
+  uint32_t getFrames() const  { return frames; }
+  uint32_t getTimedFrames() const { return timedFrames; }
+  uint32_t getMinMicros(const LEDFramePhase phase) const { return (timedFrames > 0L) ? minMicros[phase] : 0L; }
+  uint32_t getMaxMicros(const LEDFramePhase phase) const { return maxMicros[phase]; }
+  uint32_t getMeanMicros(const LEDFramePhase phase) const { return (timedFrames > 0L) ? sumMicros[phase] / timedFrames : 0L; }
+  uint32_t getPixelsWritten() const  { return pixelsWritten; }
+  uint16_t getClustersActive() const { return clustersActive; }
+  uint32_t getDroppedFrames() const  { return droppedFrames; }
+  uint32_t getMeanWireMicros() const { return (frames > 0L) ? sumWireMicros / frames : 0L; }
+
+  /*
+   * dump statistics to Serial as comma separated values, one record per line
+   */
+  static void printCSVHeader();
+  void printCSV() const;
+};
+
+#endif /* LEDFRAMESTATS_H */
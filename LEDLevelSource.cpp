@@ -0,0 +1,93 @@
+// NAME: LEDLevelSource.cpp
+//
+// DESC: Sources of level samples, e.g. for LEDPeakMeter.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDLevelSource.h"
+
+/*
+ * analog input
+ */
+LEDAnalogLevel::LEDAnalogLevel(const uint8_t pin, const uint32_t sampleInterval /* =LEVEL_SAMPLE_INTERVAL */) {
+  this->pin = pin;
+  this->sampleInterval = sampleInterval;
+  lastSample = micros() - sampleInterval;
+  maxLevel = 0;
+  numSamples = 0;
+}
+
+void LEDAnalogLevel::poll() {
+  uint32_t now = micros();
+  if (now - lastSample < sampleInterval) return;
+  lastSample = now;
+  uint16_t level = analogRead(pin) & LEVEL_MAX;
+  if ((0 == numSamples) || (level > maxLevel)) maxLevel = level;
+  if (numSamples < 0xffff) numSamples++;
+}
+
+bool LEDAnalogLevel::readLevel(uint16_t &level) {
+  poll();
+  if (0 == numSamples) return false;
+  level = maxLevel;
+  numSamples = 0;
+  return true;
+}
+
+/*
+ * stream input
+ */
+LEDStreamLevel::LEDStreamLevel(Stream &input)
+              :input(input) {
+  highBits = -1;
+}
+
+bool LEDStreamLevel::readLevel(uint16_t &level) {
+  while (input.available() > 0) {
+    uint8_t data = input.read();
+    if (data & 0x80) { // first byte of a sample
+      highBits = data & 0x7f;
+    }
+    else if (highBits >= 0) {
+      level = (((uint16_t)highBits << 7) | data) & LEVEL_MAX;
+      highBits = -1;
+      return true;
+    }
+    // else second byte without first byte: lost, wait for next sample
+  }
+  return false;
+}
+
+/*
+ * random input
+ */
+LEDRandomLevel::LEDRandomLevel(const uint16_t minLevel, const uint16_t maxLevel, const uint32_t sampleInterval /* =LEVEL_SAMPLE_INTERVAL */) {
+  this->minLevel = minLevel;
+  this->maxLevel = maxLevel;
+  this->sampleInterval = sampleInterval;
+  lastSample = micros() - sampleInterval;
+  peakLevel = 0;
+  numSamples = 0;
+}
+
+void LEDRandomLevel::poll() {
+  uint32_t now = micros();
+  uint32_t due = (now - lastSample) / sampleInterval;
+  if (0 == due) return;
+  lastSample += due * sampleInterval;
+  if (due > MAX_LEVEL_DRAWS) due = MAX_LEVEL_DRAWS;
+  for (uint16_t i=0; i<due; i++) {
+    uint16_t level = random(minLevel, maxLevel);
+    if ((0 == numSamples) || (level > peakLevel)) peakLevel = level;
+    if (numSamples < 0xffff) numSamples++;
+  }
+}
+
+bool LEDRandomLevel::readLevel(uint16_t &level) {
+  poll();
+  if (0 == numSamples) return false;
+  level = peakLevel;
+  numSamples = 0;
+  return true;
+}
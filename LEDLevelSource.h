@@ -0,0 +1,89 @@
+// NAME: LEDLevelSource.h
+//
+// DESC: Sources of level samples, e.g. for LEDPeakMeter.
+//
+//       A source delivers samples of LEVEL_BITS bits at its own rate: readLevel() returns
+//       false, as long as no new sample is available.
+//
+//       Sampled sources keep the maximum of their samples until it is read, so a peak
+//       between two reads (e.g. updates of LEDPeakMeter every 20ms) is not lost: call
+//       poll() at the sample rate, e.g. from loop() while idle, readLevel() returns the
+//       maximum since the last read. LEDRandomLevel draws all samples due since then.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDLEVELSOURCE_H
+#define LEDLEVELSOURCE_H
+
+#include <Arduino.h>
+
+#define LEVEL_BITS            10  // like the ADC of the Arduino
+#define LEVEL_MAX             ((1 << LEVEL_BITS) - 1)
+#define LEVEL_SAMPLE_INTERVAL 1000L // default sample interval in microseconds (1 kHz)
+#define MAX_LEVEL_DRAWS       64    // samples drawn at most per LEDRandomLevel::poll()
+
+class LEDLevelSource {
+protected:
+  LEDLevelSource() {}
+
+public:
+  virtual ~LEDLevelSource() {}
+
+  virtual void poll() {}   // takes a sample, if due
+  virtual bool readLevel(uint16_t &level) = 0;  // false, if no new sample is available
+};
+
+/*
+ * samples of an analog input pin
+ */
+class LEDAnalogLevel : public LEDLevelSource {
+private:
+  uint8_t   pin;
+  uint32_t  sampleInterval;   // in microseconds
+  uint32_t  lastSample;       // time of last sample in microseconds
+  uint16_t  maxLevel;         // maximum of the samples since the last read
+  uint16_t  numSamples;       // samples since the last read
+
+public:
+  LEDAnalogLevel(const uint8_t pin, const uint32_t sampleInterval = LEVEL_SAMPLE_INTERVAL);
+
+  virtual void poll();
+  virtual bool readLevel(uint16_t &level);
+};
+
+/*
+ * samples received from a Stream, e.g. Serial or a pipe on the host; every sample is sent as
+ * two bytes 0x80 | (level >> 7) and level & 0x7f, so the receiver resyncs on a lost byte
+ */
+class LEDStreamLevel : public LEDLevelSource {
+private:
+  Stream    &input;
+  int16_t   highBits;         // first byte of the sample being received, -1 if none
+
+public:
+  LEDStreamLevel(Stream &input);
+
+  virtual bool readLevel(uint16_t &level);
+};
+
+/*
+ * random samples in [minLevel, maxLevel) for testing without input
+ */
+class LEDRandomLevel : public LEDLevelSource {
+private:
+  uint16_t  minLevel;
+  uint16_t  maxLevel;
+  uint32_t  sampleInterval;   // in microseconds
+  uint32_t  lastSample;       // time of last sample in microseconds
+  uint16_t  peakLevel;        // maximum of the samples since the last read
+  uint16_t  numSamples;       // samples since the last read
+
+public:
+  LEDRandomLevel(const uint16_t minLevel, const uint16_t maxLevel, const uint32_t sampleInterval = LEVEL_SAMPLE_INTERVAL);
+
+  virtual void poll();  // draws all samples due, at most MAX_LEVEL_DRAWS
+  virtual bool readLevel(uint16_t &level);
+};
+
+#endif /* LEDLEVELSOURCE_H */
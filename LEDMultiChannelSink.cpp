@@ -0,0 +1,146 @@
+// NAME: LEDMultiChannelSink.cpp
+//
+// DESC: LEDPixelSink combining several physical LED strips (channels) into one logical LED strip.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDMultiChannelSink.h"
+
+LEDMultiChannelSink::LEDMultiChannelSink(LEDPixelSink **channels, const uint8_t numChannels) {
+  this->numChannels = (numChannels > MAX_CHANNELS) ? MAX_CHANNELS : numChannels;
+  numLEDs = 0;
+  wireMicros = 0L;
+  for (uint8_t channelNo=0; channelNo<this->numChannels; channelNo++) {
+    this->channels[channelNo] = channels[channelNo];
+    channelStart[channelNo] = numLEDs;
+    channelChanged[channelNo] = true;
+    numLEDs += channels[channelNo]->numPixels();
+  }
+}
+
+uint8_t LEDMultiChannelSink::getChannel(const uint16_t pixelNo) const {
+  uint8_t channelNo = numChannels-1;
+  while ((channelNo > 0) && (pixelNo < channelStart[channelNo])) {
+    channelNo--;
+  }
+  return channelNo;
+}
+
+void LEDMultiChannelSink::begin() {
+  for (uint8_t channelNo=0; channelNo<numChannels; channelNo++) {
+    channels[channelNo]->begin();
+  }
+}
+
+void LEDMultiChannelSink::show() {
+  uint32_t startMicros = 0L;  // start of the next channel on the wire, relative to the first one
+  wireMicros = 0L;
+
+  // start every changed channel, the idle ones first, without waiting for the transmissions
+  for (uint8_t pass=0; pass<2; pass++) {
+    for (uint8_t channelNo=0; channelNo<numChannels; channelNo++) {
+      if (channelChanged[channelNo] && ((pass > 0) || channels[channelNo]->canShow())) {
+        channels[channelNo]->show();
+        channelChanged[channelNo] = false;
+
+        uint32_t channelMicros = channels[channelNo]->getWireMicros();
+        if (channels[channelNo]->isBusy()) { // in the background, ends after its time on the wire
+          if (startMicros + channelMicros > wireMicros) wireMicros = startMicros + channelMicros;
+        }
+        else startMicros += channelMicros;    // blocked the start of the next channel
+      }
+    }
+  }
+  if (startMicros > wireMicros) wireMicros = startMicros;
+}
+
+bool LEDMultiChannelSink::canShow() {
+  for (uint8_t channelNo=0; channelNo<numChannels; channelNo++) {
+    if (channelChanged[channelNo] && !channels[channelNo]->canShow()) return false;
+  }
+  return true;
+}
+
+bool LEDMultiChannelSink::isBusy() {
+  for (uint8_t channelNo=0; channelNo<numChannels; channelNo++) {
+    if (channels[channelNo]->isBusy()) return true;
+  }
+  return false;
+}
+
+bool LEDMultiChannelSink::needsRefresh() {
+  for (uint8_t channelNo=0; channelNo<numChannels; channelNo++) {
+    if (channels[channelNo]->needsRefresh()) return true;
+  }
+  return false;
+}
+
+void LEDMultiChannelSink::setPixelColor(const uint16_t pixelNo, const uint32_t color) {
+  if (pixelNo >= numLEDs) return;
+  uint8_t channelNo = getChannel(pixelNo);
+  channels[channelNo]->setPixelColor(pixelNo - channelStart[channelNo], color);
+  channelChanged[channelNo] = true;
+}
+
+uint32_t LEDMultiChannelSink::getPixelColor(const uint16_t pixelNo) const {
+  if (pixelNo >= numLEDs) return 0L;
+  uint8_t channelNo = getChannel(pixelNo);
+  return channels[channelNo]->getPixelColor(pixelNo - channelStart[channelNo]);
+}
+
+void LEDMultiChannelSink::fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count) {
+  if ((0 == count) || (firstPixel >= numLEDs)) return;
+  uint16_t endPixel = ((uint32_t)firstPixel + count > numLEDs) ? numLEDs : firstPixel + count;
+
+  // split range at channel boundaries
+  for (uint8_t channelNo=getChannel(firstPixel); channelNo<numChannels; channelNo++) {
+    uint16_t channelEnd = channelStart[channelNo] + channels[channelNo]->numPixels();
+    uint16_t first = (firstPixel > channelStart[channelNo]) ? firstPixel : channelStart[channelNo];
+    uint16_t end = (endPixel < channelEnd) ? endPixel : channelEnd;
+    if (first < end) {
+      channels[channelNo]->fill(color, first - channelStart[channelNo], end - first);
+      channelChanged[channelNo] = true;
+    }
+    if (endPixel <= channelEnd) break;
+  }
+}
+
+void LEDMultiChannelSink::writePixels(const uint16_t firstPixel, const uint8_t *pixels, const uint16_t count) {
+  if ((0 == count) || (firstPixel >= numLEDs)) return;
+  uint16_t endPixel = ((uint32_t)firstPixel + count > numLEDs) ? numLEDs : firstPixel + count;
+
+  // split range at channel boundaries like fill()
+  for (uint8_t channelNo=getChannel(firstPixel); channelNo<numChannels; channelNo++) {
+    uint16_t channelEnd = channelStart[channelNo] + channels[channelNo]->numPixels();
+    uint16_t first = (firstPixel > channelStart[channelNo]) ? firstPixel : channelStart[channelNo];
+    uint16_t end = (endPixel < channelEnd) ? endPixel : channelEnd;
+    if (first < end) {
+      channels[channelNo]->writePixels(first - channelStart[channelNo], pixels + (first - firstPixel) * 3, end - first);
+      channelChanged[channelNo] = true;
+    }
+    if (endPixel <= channelEnd) break;
+  }
+}
+
+void LEDMultiChannelSink::setBrightness(const uint8_t brightness) {
+  for (uint8_t channelNo=0; channelNo<numChannels; channelNo++) {
+    channels[channelNo]->setBrightness(brightness);
+    channelChanged[channelNo] = true;
+  }
+}
+
+uint8_t LEDMultiChannelSink::getBrightness() const {
+  if (numChannels > 0) {
+    return channels[0]->getBrightness();
+  }
+  else return 0;
+}
+
+uint32_t LEDMultiChannelSink::getIntensity(const uint8_t colorChannel) const {
+  uint32_t sum = 0L;
+  for (uint8_t channelNo=0; channelNo<numChannels; channelNo++) {
+    sum += channels[channelNo]->getIntensity(colorChannel);
+  }
+  return sum;
+}
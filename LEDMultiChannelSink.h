@@ -0,0 +1,69 @@
+// NAME: LEDMultiChannelSink.h
+//
+// DESC: LEDPixelSink combining several physical LED strips (channels) into one logical LED strip.
+//
+//       The channels follow each other in the order given to the constructor, i.e. pixel 0 of
+//       the second channel is the pixel behind the last pixel of the first channel.
+//       show() only transmits channels with changed pixels, so static parts of an installation
+//       do not cost any transmission time, and the transmission of a long strip is split into
+//       shorter ones.
+//
+//       show() starts every changed channel before it returns; the fence is isBusy() of all
+//       channels before the next frame. Channels transmitting in the background (DMA, see
+//       LEDThreadSink on the host) overlap, channels blocking in show() like Adafruit_NeoPixel
+//       with interrupts disabled follow each other.
+//
+//       Timing model: getWireMicros() estimates the time on the wire of the last show() from
+//       the order the channels were started in: a blocking channel delays the start of the
+//       next one, a channel busy after its show() runs in parallel to the next ones. For the
+//       WS2815 installation split into 682 and 354 pixels, a frame changing both channels
+//       takes 31680us with blocking channels and 20760us in the background.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDMULTICHANNELSINK_H
+#define LEDMULTICHANNELSINK_H
+
+#include <Arduino.h>
+#include "LEDPixelSink.h"
+
+#define MAX_CHANNELS  4   // maximum number of physical LED strips
+
+class LEDMultiChannelSink : public LEDPixelSink {
+private:
+  uint8_t       numChannels;
+  LEDPixelSink  *channels[MAX_CHANNELS];
+  uint16_t      channelStart[MAX_CHANNELS];   // first logical pixel of channel
+  bool          channelChanged[MAX_CHANNELS]; // flag, if pixels of channel changed since last show()
+  uint16_t      numLEDs;                      // total number of pixels of all channels
+  uint32_t      wireMicros;                   // time on the wire of the last show(), see timing model
+
+  uint8_t getChannel(const uint16_t pixelNo) const;
+
+public:
+  LEDMultiChannelSink(LEDPixelSink **channels, const uint8_t numChannels);
+
+  virtual void begin();
+  virtual void show();
+  virtual bool canShow();
+  virtual bool isBusy();
+  virtual bool needsRefresh();
+  virtual uint32_t getWireMicros() const { return wireMicros; }
+
+  virtual uint16_t numPixels() const { return numLEDs; }
+
+  virtual void setPixelColor(const uint16_t pixelNo, const uint32_t color);
+  virtual uint32_t getPixelColor(const uint16_t pixelNo) const;
+  virtual void fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count);
+  virtual void writePixels(const uint16_t firstPixel, const uint8_t *pixels, const uint16_t count);
+
+  virtual void setBrightness(const uint8_t brightness);
+  virtual uint8_t getBrightness() const;
+
+  virtual uint32_t getIntensity(const uint8_t colorChannel) const;
+
+  uint8_t getNumChannels() const  { return numChannels; }
+};
+
+#endif /* LEDMULTICHANNELSINK_H */
@@ -0,0 +1,85 @@
+// NAME: LEDNeoPixelSink.cpp
+//
+// DESC: LEDPixelSink for WS2812/WS2815 smart pixel strips driven by the Adafruit_NeoPixel library.
+//
+// DEPENDENCIES:
+//  Adafruit_NeoPixel library from https://github.com/adafruit/Adafruit_NeoPixel
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDNeoPixelSink.h"
+#include "LEDSpanKernels.h"
+
+#ifdef USE_NEOPIXEL
+
+LEDNeoPixelSink::LEDNeoPixelSink(const uint16_t numLEDs, const uint8_t dataPin, const neoPixelType ledConfig)
+                :strip(numLEDs, dataPin, ledConfig) {
+  // same decoding of neoPixelType as Adafruit_NeoPixel::updateType()
+  rOffset = (ledConfig >> 4) & 0b11;
+  gOffset = (ledConfig >> 2) & 0b11;
+  bOffset = ledConfig & 0b11;
+  bytesPerPixel = (((ledConfig >> 6) & 0b11) == rOffset) ? 3 : 4; // white offset == red offset: no white
+#ifdef NEO_KHZ400
+  uint32_t bitNanos = (ledConfig & NEO_KHZ400) ? 2 * NEOPIXEL_BIT_NANOS : NEOPIXEL_BIT_NANOS;
+#else
+  uint32_t bitNanos = NEOPIXEL_BIT_NANOS;
+#endif
+  wireMicros = (uint32_t)numLEDs * bytesPerPixel * bitNanos / 125 + NEOPIXEL_LATCH_MICROS;  // 8 bits per byte
+}
+
+uint32_t LEDNeoPixelSink::getTransmittedColor(const uint16_t pixelNo) const {
+  const uint8_t *pixel = strip.getPixels() + (uint32_t)pixelNo * bytesPerPixel;
+  return ((uint32_t)pixel[rOffset] << 16) | ((uint32_t)pixel[gOffset] << 8) | pixel[bOffset];
+}
+
+void LEDNeoPixelSink::countIntensity() {
+  intensity[0] = intensity[1] = intensity[2] = 0L;
+  for (uint16_t pixelNo=0; pixelNo<numPixels(); pixelNo++) {
+    addIntensity(getTransmittedColor(pixelNo));
+  }
+}
+
+void LEDNeoPixelSink::setPixelColor(const uint16_t pixelNo, const uint32_t color) {
+  if (pixelNo >= numPixels()) return;
+  subIntensity(getTransmittedColor(pixelNo));
+  strip.setPixelColor(pixelNo, color);
+  addIntensity(getTransmittedColor(pixelNo));
+}
+
+void LEDNeoPixelSink::fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count) {
+  if ((0 == count) || (firstPixel >= numPixels())) return; // Adafruit_NeoPixel::fill() would fill up to the end of the strip
+  uint16_t endPixel = ((uint32_t)firstPixel + count > numPixels()) ? numPixels() : firstPixel + count;
+  for (uint16_t pixelNo=firstPixel; pixelNo<endPixel; pixelNo++) {
+    subIntensity(getTransmittedColor(pixelNo));
+  }
+  strip.fill(color, firstPixel, endPixel - firstPixel);
+  addIntensity(getTransmittedColor(firstPixel), endPixel - firstPixel);
+}
+
+/*
+ * write into the pixel buffer of Adafruit_NeoPixel like its setPixelColor(), but a whole span at once
+ */
+void LEDNeoPixelSink::writePixels(const uint16_t firstPixel, const uint8_t *pixels, const uint16_t count) {
+  if (3 != bytesPerPixel) { // no kernel for RGBW
+    LEDPixelSink::writePixels(firstPixel, pixels, count);
+    return;
+  }
+  if ((0 == count) || (firstPixel >= numPixels())) return;
+  uint16_t endPixel = ((uint32_t)firstPixel + count > numPixels()) ? numPixels() : firstPixel + count;
+  uint8_t *wire = strip.getPixels() + (uint32_t)firstPixel * 3;
+  uint32_t before[3] = { 0L, 0L, 0L };
+  uint32_t after[3] = { 0L, 0L, 0L };
+  spanIntensity(wire, endPixel - firstPixel, before);
+  spanSwizzle(wire, pixels, rOffset, gOffset, bOffset, endPixel - firstPixel);
+  spanScale(wire, strip.getBrightness() + 1, endPixel - firstPixel);  // 256 at full brightness
+  spanIntensity(wire, endPixel - firstPixel, after);
+  changeIntensity(before, after, rOffset, gOffset, bOffset);
+}
+
+void LEDNeoPixelSink::setBrightness(const uint8_t brightness) {
+  strip.setBrightness(brightness);  // rescales all pixels
+  countIntensity();
+}
+
+#endif /* USE_NEOPIXEL */
@@ -0,0 +1,61 @@
+// NAME: LEDNeoPixelSink.h
+//
+// DESC: LEDPixelSink for WS2812/WS2815 smart pixel strips driven by the Adafruit_NeoPixel library.
+//
+// DEPENDENCIES:
+//  Adafruit_NeoPixel library from https://github.com/adafruit/Adafruit_NeoPixel
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDNEOPIXELSINK_H
+#define LEDNEOPIXELSINK_H
+
+#include "LEDStripTest.h"
+
+#ifdef USE_NEOPIXEL
+
+#include <Adafruit_NeoPixel.h>
+#include "LEDPixelSink.h"
+
+/*
+ * timing of the one-wire protocol for getWireMicros(): every bit takes 1.25us at 800 kHz
+ * (30us per RGB pixel), followed by the reset time, which latches the colors
+ */
+#define NEOPIXEL_BIT_NANOS      1250L   // 800 kHz, NEO_KHZ400: twice as long
+#define NEOPIXEL_LATCH_MICROS   300L    // WS2812B and WS2815 need at least 280us
+
+class LEDNeoPixelSink : public LEDPixelSink {
+private:
+  Adafruit_NeoPixel strip;
+  uint8_t   rOffset;          // layout of pixels in Adafruit_NeoPixel::getPixels()
+  uint8_t   gOffset;
+  uint8_t   bOffset;
+  uint8_t   bytesPerPixel;
+  uint32_t  wireMicros;       // time of show() on the wire
+
+  uint32_t getTransmittedColor(const uint16_t pixelNo) const; // color with brightness applied
+  void countIntensity();
+
+public:
+  LEDNeoPixelSink(const uint16_t numLEDs, const uint8_t dataPin, const neoPixelType ledConfig);
+
+  virtual void begin()    { strip.begin(); }
+  virtual void show()     { strip.show(); }
+  virtual bool canShow()  { return strip.canShow(); }
+  virtual uint32_t getWireMicros() const { return wireMicros; }
+
+  virtual uint16_t numPixels() const { return strip.numPixels(); }
+
+  virtual void setPixelColor(const uint16_t pixelNo, const uint32_t color);
+  virtual uint32_t getPixelColor(const uint16_t pixelNo) const { return strip.getPixelColor(pixelNo); }
+  virtual void fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count);
+  virtual void writePixels(const uint16_t firstPixel, const uint8_t *pixels, const uint16_t count);
+
+  virtual void setBrightness(const uint8_t brightness);
+  virtual uint8_t getBrightness() const { return strip.getBrightness(); }
+};
+
+#endif /* USE_NEOPIXEL */
+
+#endif /* LEDNEOPIXELSINK_H */
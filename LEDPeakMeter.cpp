@@ -0,0 +1,88 @@
+// NAME: LEDPeakMeter.cpp
+//
+// DESC: LEDCluster showing a green-yellow-red level bar with a varying peak.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDPeakMeter.h"
+
+LEDPeakMeter::LEDPeakMeter(const uint16_t length, const uint8_t peakLength)
+             :LEDCluster(length+peakLength),
+              randomLevel(((uint32_t)(length-peakLength) << LEVEL_BITS) / (length+peakLength),
+                          ((uint32_t)(length+peakLength) << LEVEL_BITS) / (length+peakLength)) {
+  this->peakLength = peakLength;
+  source = &randomLevel;
+  target = 0;
+  barEnd = 0;
+  peakEnd = 0;
+  holdCount = 0;
+  peakHold = 0;
+  decay = 0;
+}
+
+void LEDPeakMeter::setLevelSource(LEDLevelSource *source) {
+  this->source = (NULL != source) ? source : &randomLevel;
+}
+
+void LEDPeakMeter::update(const uint32_t steps) {
+  /*
+   * maximum of all samples since the last update, mapped to the length of the bar
+   */
+  uint16_t level, maxLevel = 0;
+  uint16_t numSamples = 0;
+  while ((numSamples < MAX_LEVEL_SAMPLES) && source->readLevel(level)) {
+    if (level > maxLevel) maxLevel = level;
+    numSamples++;
+  }
+  if (numSamples > 0) {
+    target = ((uint32_t)maxLevel + 1) * length >> LEVEL_BITS;
+  }
+
+  /*
+   * rise immediately, fall by decay
+   */
+  uint16_t oldBarEnd = barEnd;
+  if ((target >= barEnd) || (0 == decay)) {
+    barEnd = target;
+  }
+  else {
+    uint32_t fall = (uint32_t)decay * steps;
+    barEnd = ((uint32_t)(barEnd - target) > fall) ? barEnd - fall : target;
+  }
+  if (barEnd < oldBarEnd) {
+    markDirty(barEnd, oldBarEnd);
+  }
+  else markDirty(oldBarEnd, barEnd);
+
+  /*
+   * hold peak, then let it fall by one pixel per step
+   */
+  uint16_t oldPeakEnd = peakEnd;
+  if (0 == peakHold) {
+    peakEnd = 0;
+  }
+  else if (barEnd >= peakEnd) {
+    peakEnd = barEnd;
+    holdCount = peakHold;
+  }
+  else if (holdCount >= steps) {
+    holdCount -= steps;
+  }
+  else {
+    uint32_t fall = steps - holdCount;
+    peakEnd = ((uint32_t)(peakEnd - barEnd) > fall) ? peakEnd - fall : barEnd;
+    holdCount = 0;
+  }
+  if (peakEnd != oldPeakEnd) {
+    if (oldPeakEnd > 0) markDirty(oldPeakEnd-1, oldPeakEnd);
+    if (peakEnd > 0) markDirty(peakEnd-1, peakEnd);
+  }
+}
+
+uint32_t LEDPeakMeter::getColor(const uint16_t no) const {
+  if ((no < barEnd) || (no+1 == peakEnd)) {
+    return getRGBPixel(no); // gradient, see initPeakMeter()
+  }
+  else return COLOR_BLACK;
+}
@@ -0,0 +1,51 @@
+// NAME: LEDPeakMeter.h
+//
+// DESC: LEDCluster showing a green-yellow-red level bar with a varying peak.
+//
+//       The level is driven by an LEDLevelSource, by default random samples around the
+//       base length. The bar falls by the decay per update step, and the peak pixel is
+//       held for some steps before it falls by one pixel per step. As the gradient of
+//       the bar is constant, an update marks only the pixels between the old and the new
+//       level dirty.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDPEAKMETER_H
+#define LEDPEAKMETER_H
+
+#include "LEDCluster.h"
+#include "LEDLevelSource.h"
+
+#define MAX_LEVEL_SAMPLES   255 // maximum number of samples read per update
+
+class LEDPeakMeter : public LEDCluster {
+private:
+  uint8_t   peakLength;         // maximum deviation of level from base length
+  LEDRandomLevel randomLevel;   // default level source
+  LEDLevelSource *source;       // source of level samples
+  uint16_t  target;             // length of bar for the last sample
+  uint16_t  barEnd;             // length of bar shown
+  uint16_t  peakEnd;            // peak pixel + 1, 0 for none
+  uint16_t  holdCount;          // steps until the peak falls
+  uint16_t  peakHold;           // steps to hold the peak, 0 for no peak
+  uint8_t   decay;              // pixels per step the bar falls, 0 for immediately
+
+public:
+  LEDPeakMeter(const uint16_t length, const uint8_t peakLength);
+
+  uint8_t getPeakLength() const { return peakLength; }
+
+  void setLevelSource(LEDLevelSource *source);  // NULL for random levels
+  void setDecay(const uint8_t pixelsPerStep)  { decay = pixelsPerStep; }
+  void setPeakHold(const uint16_t steps)      { peakHold = steps; }
+
+  uint16_t getBarEnd() const  { return barEnd; }
+  uint16_t getPeakEnd() const { return peakEnd; }
+
+  virtual bool isAnimated() const { return true; }
+  virtual void update(const uint32_t steps);
+  virtual uint32_t getColor(const uint16_t no) const;
+};
+
+#endif /* LEDPEAKMETER_H */
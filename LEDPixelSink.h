@@ -0,0 +1,78 @@
+// NAME: LEDPixelSink.h
+//
+// DESC: Interface of an output for the pixels of an LED strip, which LEDClusterController renders into.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDPIXELSINK_H
+#define LEDPIXELSINK_H
+
+#include <Arduino.h>
+#include "LEDCluster.h"
+
+class LEDPixelSink {
+protected:
+  uint32_t intensity[3];  // sums of red, green and blue values of all pixels, kept up to date by every write
+
+  LEDPixelSink() { intensity[0] = intensity[1] = intensity[2] = 0L; }
+
+  void addIntensity(const uint32_t color, const uint16_t count = 1);
+  void subIntensity(const uint32_t color, const uint16_t count = 1);
+  void changeIntensity(const uint32_t *before, const uint32_t *after, const uint8_t rOffset = 0, const uint8_t gOffset = 1, const uint8_t bOffset = 2);
+
+public:
+  virtual ~LEDPixelSink() {}
+
+  virtual void begin() = 0;           // initialize output
+  virtual void show() = 0;            // transmit pixels to the LED strip
+  virtual bool canShow() = 0;         // true, if the next show() will not wait for the LED strip
+  virtual bool isBusy() { return false; } // true, while a show() is still transmitting in the background
+  void waitIdle() { while (isBusy()) yield(); }
+  virtual bool needsRefresh() { return false; } // true, if show() must be called every frame, even without changes
+  virtual uint32_t getWireMicros() const { return 0L; } // estimated time on the wire of the last show(), 0 if unknown
+
+  virtual uint16_t numPixels() const = 0;
+
+  virtual void setPixelColor(const uint16_t pixelNo, const uint32_t color) = 0;
+  virtual uint32_t getPixelColor(const uint16_t pixelNo) const = 0;
+  virtual void fill(const uint32_t color, const uint16_t firstPixel, const uint16_t count) = 0; // count=0 sets no pixel
+  void clear() { fill(0L, 0, numPixels()); }
+
+  // span operations, see LEDSpanKernels.h; the defaults work pixel by pixel
+  virtual void writePixels(const uint16_t firstPixel, const uint8_t *pixels, const uint16_t count); // R-G-B triples
+  virtual bool blendFill(const BlendMode mode, const uint32_t color, const uint16_t firstPixel, const uint16_t count) { return false; } // false: not supported
+
+  virtual void setBrightness(const uint8_t brightness) = 0;
+  virtual uint8_t getBrightness() const = 0;
+
+  // sum of channel 0=red, 1=green or 2=blue of all pixels as transmitted, i.e. with brightness applied
+  virtual uint32_t getIntensity(const uint8_t channel) const { return intensity[channel]; }
+};
+
+inline void LEDPixelSink::addIntensity(const uint32_t color, const uint16_t count /* =1 */) {
+  intensity[0] += (uint32_t)((color >> 16) & 0xff) * count;
+  intensity[1] += (uint32_t)((color >> 8) & 0xff) * count;
+  intensity[2] += (uint32_t)(color & 0xff) * count;
+}
+
+inline void LEDPixelSink::subIntensity(const uint32_t color, const uint16_t count /* =1 */) {
+  intensity[0] -= (uint32_t)((color >> 16) & 0xff) * count;
+  intensity[1] -= (uint32_t)((color >> 8) & 0xff) * count;
+  intensity[2] -= (uint32_t)(color & 0xff) * count;
+}
+
+// sums of spanIntensity() before and after writing a span, whose triples have red, green and blue at the offsets
+inline void LEDPixelSink::changeIntensity(const uint32_t *before, const uint32_t *after, const uint8_t rOffset /* =0 */, const uint8_t gOffset /* =1 */, const uint8_t bOffset /* =2 */) {
+  intensity[0] += after[rOffset] - before[rOffset];
+  intensity[1] += after[gOffset] - before[gOffset];
+  intensity[2] += after[bOffset] - before[bOffset];
+}
+
+inline void LEDPixelSink::writePixels(const uint16_t firstPixel, const uint8_t *pixels, const uint16_t count) {
+  for (uint16_t no=0; no<count; no++, pixels+=3) {
+    setPixelColor(firstPixel + no, ((uint32_t)pixels[0] << 16) | ((uint32_t)pixels[1] << 8) | pixels[2]);
+  }
+}
+
+#endif /* LEDPIXELSINK_H */
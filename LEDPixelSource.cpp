@@ -0,0 +1,54 @@
+// NAME: LEDPixelSource.cpp
+//
+// DESC: LEDCluster emitting pixels of one hue from its center, which fade out
+//       while they move to both ends of the cluster.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDPixelSource.h"
+#include "LEDColor.h"
+
+LEDPixelSource::LEDPixelSource(const uint16_t length, const uint16_t hue)
+               :LEDCluster(length) {
+  sourceHue = hue;
+  center = length / 2;
+  head = 0;
+  emitted = 1;
+  settling = center;
+  fadingDelta = (center > 0) ? 255 / center : 255;
+  if (NULL != pixels) pixels[head].hsvColor.hue = hue;
+}
+
+void LEDPixelSource::setSourceHue(const uint16_t hue) {
+  sourceHue = hue;
+  settling = center + 1;  // moves out with the next steps
+}
+
+void LEDPixelSource::update(const uint32_t steps) {
+  uint16_t numSteps = (steps > center) ? center + 1 : steps; // all older pixels have left the cluster
+  for (uint16_t step=0; step<numSteps; step++) {
+    head = (head < center) ? head + 1 : 0;
+    pixels[head].hsvColor.hue = sourceHue;
+  }
+
+  if (emitted < center + 1) {
+    emitted = ((uint32_t)emitted + numSteps > center + 1U) ? center + 1 : emitted + numSteps;
+    markDirty();
+  }
+  if (settling > 0) {
+    settling = (settling > numSteps) ? settling - numSteps : 0;
+    markDirty();
+  }
+}
+
+uint32_t LEDPixelSource::getColor(const uint16_t no) const {
+  uint16_t distance = (no < center) ? center - no : no - center;
+  if (distance >= emitted) return COLOR_BLACK;  // not yet reached
+  uint16_t fading = distance * fadingDelta;
+  if (fading >= 255) return COLOR_BLACK;        // faded out
+
+  // paler and darker with distance, so the outermost pixels fade to black instead of white
+  uint16_t entry = (head >= distance) ? head - distance : head + center + 1 - distance;
+  return gammaColorHSV(pixels[entry].hsvColor.hue, 255 - fading, 255 - fading);
+}
@@ -0,0 +1,39 @@
+// NAME: LEDPixelSource.h
+//
+// DESC: LEDCluster emitting pixels of one hue from its center, which fade out
+//       while they move to both ends of the cluster.
+//
+//       The emitted hues are kept in a ring buffer, whose head moves by one entry per
+//       update step. A pixel at distance d from the center shows the hue emitted d steps
+//       ago, faded by its age: paler and darker, down to black at the ends of the cluster.
+//       So a step costs the same for long and short clusters.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDPIXELSOURCE_H
+#define LEDPIXELSOURCE_H
+
+#include "LEDCluster.h"
+
+class LEDPixelSource : public LEDCluster {
+private:
+  uint16_t  sourceHue;          // hue of emitted pixels
+  uint16_t  center;             // pixel of the source; the ring buffer is pixels[0..center]
+  uint16_t  head;               // entry of the pixel emitted last
+  uint16_t  emitted;            // number of valid entries, up to center+1
+  uint16_t  settling;           // steps until all entries have the current source hue
+  uint8_t   fadingDelta;        // fading of saturation and value per pixel of distance from the center
+
+public:
+  LEDPixelSource(const uint16_t length, const uint16_t hue);
+
+  void setSourceHue(const uint16_t hue);
+  uint16_t getSourceHue() const { return sourceHue; }
+
+  virtual bool isAnimated() const { return true; }
+  virtual void update(const uint32_t steps);
+  virtual uint32_t getColor(const uint16_t no) const;
+};
+
+#endif /* LEDPIXELSOURCE_H */
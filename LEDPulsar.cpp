@@ -0,0 +1,21 @@
+// NAME: LEDPulsar.cpp
+//
+// DESC: LEDCluster of HSV colored pixels, which pulse by changing their saturation.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDPulsar.h"
+
+LEDPulsar::LEDPulsar(const uint16_t length, const uint16_t width, const uint8_t saturationInterval)
+          :LEDCluster(length, width) {
+  this->saturationInterval = saturationInterval;
+}
+
+void LEDPulsar::update(const uint32_t steps) {
+  uint8_t saturationDelta = saturationInterval * steps; // saturation wraps around at 256
+  for (uint16_t i=0; i<length; i++) {
+    pixels[i].hsvColor.saturation += saturationDelta;
+  }
+  markDirty();
+}
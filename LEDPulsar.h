@@ -0,0 +1,27 @@
+// NAME: LEDPulsar.h
+//
+// DESC: LEDCluster of HSV colored pixels, which pulse by changing their saturation.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDPULSAR_H
+#define LEDPULSAR_H
+
+#include "LEDCluster.h"
+
+class LEDPulsar : public LEDCluster {
+private:
+  uint8_t   saturationInterval; // change of saturation per update step
+
+public:
+  LEDPulsar(const uint16_t length, const uint16_t width, const uint8_t saturationInterval);
+
+  uint8_t getSaturationInterval() const { return saturationInterval; }
+
+  virtual bool isAnimated() const { return true; }
+  virtual void update(const uint32_t steps);
+  virtual uint32_t getColor(const uint16_t no) const { return getHSVPixel(no); }
+};
+
+#endif /* LEDPULSAR_H */
@@ -0,0 +1,89 @@
+// NAME: LEDScene.h
+//
+// DESC: Compact binary description of a scene of LEDClusters, which is kept in PROGMEM and
+//       loaded by LEDClusterController::loadScene().
+//
+//       A scene is a byte array built with the SCENE_... macros below and closed by SCENE_END.
+//       Every cluster starts with one of the cluster records, which ends with the position
+//       of the cluster in the LED strip. It may be followed by modifier records, which apply
+//       to that cluster, e.g.
+//
+//         const uint8_t scene[] PROGMEM = {
+//           SCENE_RGB_PIXEL(COLOR_RED, 1, 0),     // red pixel at position 0,
+//             SCENE_MOVE(LtR, 1000L),             // moving right every second,
+//             SCENE_BACK_AND_FORTH,               // back and forth
+//           SCENE_RGB_RAINBOW(6, 100),            // rainbow of 6 pixels at position 100
+//           SCENE_END
+//         };
+//
+//       16 and 32 bit values are stored in little endian, colors as R-G-B.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDSCENE_H
+#define LEDSCENE_H
+
+#include <Arduino.h>
+
+/*
+ * record types
+ */
+#define SCENE_OP_END            0x00
+#define SCENE_OP_RGB_PIXEL      0x01  // color(3) width(2) position(2)
+#define SCENE_OP_RGB_RAINBOW    0x02  // length(2) position(2)
+#define SCENE_OP_RGB_PATTERN    0x03  // color(3) pattern(1) position(2)
+#define SCENE_OP_PULSAR_PIXEL   0x04  // hue(2) saturationInterval(1) width(2) position(2)
+#define SCENE_OP_PULSAR_RAINBOW 0x05  // saturationInterval(1) length(2) position(2)
+#define SCENE_OP_PIXEL_SOURCE   0x06  // length(2) hue(2) position(2)
+#define SCENE_OP_PEAK_METER     0x07  // length(2) peakLength(1) position(2)
+#define SCENE_OP_MODIFIER       0x10  // first modifier record
+#define SCENE_OP_MOVE           0x10  // direction(1) updateInterval(4)
+#define SCENE_OP_WRAP_AROUND    0x11
+#define SCENE_OP_BACK_AND_FORTH 0x12
+#define SCENE_OP_START          0x13  // startTime(4), relative to loading the scene, startInterval(4)
+#define SCENE_OP_LAYER          0x14  // layer(1) blendMode(1)
+#define SCENE_OP_VELOCITY       0x15  // velocity(4) acceleration(4), 16.16 fixed-point
+
+#define SCENE_BYTES16(value)  (uint8_t)((uint16_t)(value) & 0xff), (uint8_t)((uint16_t)(value) >> 8)
+#define SCENE_BYTES32(value)  SCENE_BYTES16((uint32_t)(value) & 0xffff), SCENE_BYTES16((uint32_t)(value) >> 16)
+#define SCENE_COLOR(color)    (uint8_t)(((color) >> 16) & 0xff), (uint8_t)(((color) >> 8) & 0xff), (uint8_t)((color) & 0xff)
+
+/*
+ * cluster records, see the LEDCluster::init...() methods
+ */
+#define SCENE_RGB_PIXEL(color, width, pos) \
+  SCENE_OP_RGB_PIXEL, SCENE_COLOR(color), SCENE_BYTES16(width), SCENE_BYTES16(pos)
+#define SCENE_RGB_RAINBOW(length, pos) \
+  SCENE_OP_RGB_RAINBOW, SCENE_BYTES16(length), SCENE_BYTES16(pos)
+#define SCENE_RGB_PATTERN(color, pattern, pos) \
+  SCENE_OP_RGB_PATTERN, SCENE_COLOR(color), (uint8_t)(pattern), SCENE_BYTES16(pos)
+#define SCENE_PULSAR_PIXEL(hue, saturationInterval, width, pos) \
+  SCENE_OP_PULSAR_PIXEL, SCENE_BYTES16(hue), (uint8_t)(saturationInterval), SCENE_BYTES16(width), SCENE_BYTES16(pos)
+#define SCENE_PULSAR_RAINBOW(saturationInterval, length, pos) \
+  SCENE_OP_PULSAR_RAINBOW, (uint8_t)(saturationInterval), SCENE_BYTES16(length), SCENE_BYTES16(pos)
+#define SCENE_PIXEL_SOURCE(length, hue, pos) \
+  SCENE_OP_PIXEL_SOURCE, SCENE_BYTES16(length), SCENE_BYTES16(hue), SCENE_BYTES16(pos)
+#define SCENE_PEAK_METER(length, peakLength, pos) \
+  SCENE_OP_PEAK_METER, SCENE_BYTES16(length), (uint8_t)(peakLength), SCENE_BYTES16(pos)
+
+/*
+ * modifier records of the preceding cluster
+ */
+#define SCENE_MOVE(direction, interval) \
+  SCENE_OP_MOVE, (uint8_t)(direction), SCENE_BYTES32(interval)
+#define SCENE_WRAP_AROUND \
+  SCENE_OP_WRAP_AROUND
+#define SCENE_BACK_AND_FORTH \
+  SCENE_OP_BACK_AND_FORTH
+#define SCENE_START(time, interval) \
+  SCENE_OP_START, SCENE_BYTES32(time), SCENE_BYTES32(interval)
+#define SCENE_LAYER(layer, mode) \
+  SCENE_OP_LAYER, (uint8_t)(layer), (uint8_t)(mode)
+#define SCENE_VELOCITY(velocity, acceleration) \
+  SCENE_OP_VELOCITY, SCENE_BYTES32(velocity), SCENE_BYTES32(acceleration)
+
+#define SCENE_END \
+  SCENE_OP_END
+
+#endif /* LEDSCENE_H */
@@ -0,0 +1,445 @@
+// NAME: LEDSpanKernels.cpp
+//
+// DESC: Kernels for the stages of the composition of a frame, which work on spans of pixels
+//       in packed buffers instead of one PixelColor or uint32_t color at a time.
+//
+//       Every kernel runs its widest vector loop first and leaves the rest of the span to the
+//       next narrower one, down to the scalar loop. The R-G-B triples repeat every 48 bytes
+//       in 16 byte vectors (96 bytes in 32 byte vectors), so uniform colors are blended with
+//       a pattern of 3 vectors.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <string.h>
+#include "LEDStripTest.h"
+#include "LEDSpanKernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(USE_ARM_SIMD) && defined(__ARM_NEON)  // not built and tested yet, see LEDStripTest.h
+#include <arm_neon.h>
+#define SPAN_NEON 1     // 16 bytes per instruction
+#elif defined(USE_ARM_SIMD) && defined(__ARM_FEATURE_SIMD32)
+#include <arm_acle.h>
+#define SPAN_SIMD32 1   // Cortex-M DSP extension: 4 bytes per instruction, unaligned words allowed
+#endif
+
+#if !defined(__AVR__) && !defined(__SSE2__) && !defined(SPAN_NEON)
+#define SPAN_SWAR 1     // 2 bytes per multiplication in an aligned 32 bit word
+#endif
+
+/*
+ * scalar helpers, which also handle the tails of the vectorized loops
+ */
+static inline uint8_t addChannel(const uint8_t below, const uint8_t color) {
+  uint16_t sum = below + color;
+  return (sum > 255) ? 255 : sum;
+}
+
+static inline uint8_t maxChannel(const uint8_t below, const uint8_t color) {
+  return (below > color) ? below : color;
+}
+
+#if defined(__SSE2__) || defined(SPAN_SIMD32)
+// pattern of R-G-B triples of color, bytes must be a multiple of 3
+static void repeatColor(uint8_t *pattern, const uint32_t color, const uint8_t bytes) {
+  for (uint8_t i=0; i<bytes; i+=3) {
+    pattern[i]   = (color >> 16) & 0xff;
+    pattern[i+1] = (color >> 8) & 0xff;
+    pattern[i+2] = color & 0xff;
+  }
+}
+#endif
+
+/*
+ * blend modes of whole vectors, BlendReplace is handled by the callers
+ */
+#if defined(__AVX2__)
+static inline __m256i blendAVX2(const BlendMode mode, const __m256i below, const __m256i color) {
+  return (BlendAdd == mode) ? _mm256_adds_epu8(below, color) : _mm256_max_epu8(below, color);
+}
+#endif
+
+#if defined(__SSE2__)
+static inline __m128i blendSSE2(const BlendMode mode, const __m128i below, const __m128i color) {
+  return (BlendAdd == mode) ? _mm_adds_epu8(below, color) : _mm_max_epu8(below, color);
+}
+#elif defined(SPAN_NEON)
+static inline uint8x16_t blendNEON(const BlendMode mode, const uint8x16_t below, const uint8x16_t color) {
+  return (BlendAdd == mode) ? vqaddq_u8(below, color) : vmaxq_u8(below, color);
+}
+#elif defined(SPAN_SIMD32)
+static inline uint32_t blendSIMD32(const BlendMode mode, const uint32_t below, const uint32_t color) {
+  if (BlendAdd == mode) return __uqadd8(below, color);
+  else return __uqadd8(__uqsub8(below, color), color); // max(a, b) = b + saturated(a - b)
+}
+#endif
+
+/*
+ * fill
+ */
+void spanFill(uint8_t *pixels, const uint32_t color, const uint16_t count) {
+  uint8_t *pixel = pixels;
+  uint8_t *end = pixels + (uint32_t)count * 3;
+
+#if defined(__SSE2__) || defined(SPAN_SIMD32)
+  uint8_t pattern[96];
+  repeatColor(pattern, color, sizeof(pattern));
+#endif
+#if defined(__AVX2__)
+  {
+    __m256i fill0 = _mm256_loadu_si256((const __m256i *)pattern);
+    __m256i fill1 = _mm256_loadu_si256((const __m256i *)(pattern + 32));
+    __m256i fill2 = _mm256_loadu_si256((const __m256i *)(pattern + 64));
+    for (; end - pixel >= 96; pixel += 96) {
+      _mm256_storeu_si256((__m256i *)pixel, fill0);
+      _mm256_storeu_si256((__m256i *)(pixel + 32), fill1);
+      _mm256_storeu_si256((__m256i *)(pixel + 64), fill2);
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    __m128i fill0 = _mm_loadu_si128((const __m128i *)pattern);
+    __m128i fill1 = _mm_loadu_si128((const __m128i *)(pattern + 16));
+    __m128i fill2 = _mm_loadu_si128((const __m128i *)(pattern + 32));
+    for (; end - pixel >= 48; pixel += 48) {
+      _mm_storeu_si128((__m128i *)pixel, fill0);
+      _mm_storeu_si128((__m128i *)(pixel + 16), fill1);
+      _mm_storeu_si128((__m128i *)(pixel + 32), fill2);
+    }
+  }
+#elif defined(SPAN_NEON)
+  uint8x16x3_t fill;
+  fill.val[0] = vdupq_n_u8((color >> 16) & 0xff);
+  fill.val[1] = vdupq_n_u8((color >> 8) & 0xff);
+  fill.val[2] = vdupq_n_u8(color & 0xff);
+  for (; end - pixel >= 48; pixel += 48) {
+    vst3q_u8(pixel, fill);
+  }
+#elif defined(SPAN_SIMD32)
+  for (; end - pixel >= 12; pixel += 12) {
+    memcpy(pixel, pattern, 12);   // 3 word stores
+  }
+#endif
+
+  uint8_t red   = (color >> 16) & 0xff;
+  uint8_t green = (color >> 8) & 0xff;
+  uint8_t blue  = color & 0xff;
+  for (; pixel < end; pixel += 3) {
+    pixel[0] = red;
+    pixel[1] = green;
+    pixel[2] = blue;
+  }
+}
+
+/*
+ * blend of a uniform color
+ */
+void spanBlend(uint8_t *pixels, const BlendMode mode, const uint32_t color, const uint16_t count) {
+  if ((BlendAdd != mode) && (BlendMax != mode)) {
+    spanFill(pixels, color, count);
+    return;
+  }
+  uint8_t *pixel = pixels;
+  uint8_t *end = pixels + (uint32_t)count * 3;
+
+#if defined(__SSE2__) || defined(SPAN_SIMD32)
+  uint8_t pattern[96];
+  repeatColor(pattern, color, sizeof(pattern));
+#endif
+#if defined(__AVX2__)
+  {
+    __m256i color0 = _mm256_loadu_si256((const __m256i *)pattern);
+    __m256i color1 = _mm256_loadu_si256((const __m256i *)(pattern + 32));
+    __m256i color2 = _mm256_loadu_si256((const __m256i *)(pattern + 64));
+    for (; end - pixel >= 96; pixel += 96) {
+      __m256i *vector = (__m256i *)pixel;
+      _mm256_storeu_si256(vector, blendAVX2(mode, _mm256_loadu_si256(vector), color0));
+      _mm256_storeu_si256(vector + 1, blendAVX2(mode, _mm256_loadu_si256(vector + 1), color1));
+      _mm256_storeu_si256(vector + 2, blendAVX2(mode, _mm256_loadu_si256(vector + 2), color2));
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    __m128i color0 = _mm_loadu_si128((const __m128i *)pattern);
+    __m128i color1 = _mm_loadu_si128((const __m128i *)(pattern + 16));
+    __m128i color2 = _mm_loadu_si128((const __m128i *)(pattern + 32));
+    for (; end - pixel >= 48; pixel += 48) {
+      __m128i *vector = (__m128i *)pixel;
+      _mm_storeu_si128(vector, blendSSE2(mode, _mm_loadu_si128(vector), color0));
+      _mm_storeu_si128(vector + 1, blendSSE2(mode, _mm_loadu_si128(vector + 1), color1));
+      _mm_storeu_si128(vector + 2, blendSSE2(mode, _mm_loadu_si128(vector + 2), color2));
+    }
+  }
+#elif defined(SPAN_NEON)
+  {
+    uint8x16_t red   = vdupq_n_u8((color >> 16) & 0xff);
+    uint8x16_t green = vdupq_n_u8((color >> 8) & 0xff);
+    uint8x16_t blue  = vdupq_n_u8(color & 0xff);
+    for (; end - pixel >= 48; pixel += 48) {
+      uint8x16x3_t rgb = vld3q_u8(pixel);   // de-interleaved into red, green and blue
+      rgb.val[0] = blendNEON(mode, rgb.val[0], red);
+      rgb.val[1] = blendNEON(mode, rgb.val[1], green);
+      rgb.val[2] = blendNEON(mode, rgb.val[2], blue);
+      vst3q_u8(pixel, rgb);
+    }
+  }
+#elif defined(SPAN_SIMD32)
+  uint32_t color0, color1, color2;
+  memcpy(&color0, pattern, 4);
+  memcpy(&color1, pattern + 4, 4);
+  memcpy(&color2, pattern + 8, 4);
+  for (; end - pixel >= 12; pixel += 12) {
+    uint32_t words[3];
+    memcpy(words, pixel, 12);
+    words[0] = blendSIMD32(mode, words[0], color0);
+    words[1] = blendSIMD32(mode, words[1], color1);
+    words[2] = blendSIMD32(mode, words[2], color2);
+    memcpy(pixel, words, 12);
+  }
+#endif
+
+  uint8_t red   = (color >> 16) & 0xff;
+  uint8_t green = (color >> 8) & 0xff;
+  uint8_t blue  = color & 0xff;
+  if (BlendAdd == mode) {
+    for (; pixel < end; pixel += 3) {
+      pixel[0] = addChannel(pixel[0], red);
+      pixel[1] = addChannel(pixel[1], green);
+      pixel[2] = addChannel(pixel[2], blue);
+    }
+  }
+  else {
+    for (; pixel < end; pixel += 3) {
+      pixel[0] = maxChannel(pixel[0], red);
+      pixel[1] = maxChannel(pixel[1], green);
+      pixel[2] = maxChannel(pixel[2], blue);
+    }
+  }
+}
+
+/*
+ * brightness, every byte is scaled alike
+ */
+void spanScale(uint8_t *pixels, const uint16_t scale, const uint16_t count) {
+  if (scale >= 256) return; // full brightness
+  uint8_t *pixel = pixels;
+  uint8_t *end = pixels + (uint32_t)count * 3;
+
+#if defined(__AVX2__)
+  {
+    __m256i factor = _mm256_set1_epi16(scale);
+    __m256i zero = _mm256_setzero_si256();
+    for (; end - pixel >= 32; pixel += 32) {
+      __m256i bytes = _mm256_loadu_si256((const __m256i *)pixel);
+      __m256i low = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(bytes, zero), factor), 8);
+      __m256i high = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(bytes, zero), factor), 8);
+      _mm256_storeu_si256((__m256i *)pixel, _mm256_packus_epi16(low, high)); // same lanes as unpacked
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    __m128i factor = _mm_set1_epi16(scale);
+    __m128i zero = _mm_setzero_si128();
+    for (; end - pixel >= 16; pixel += 16) {
+      __m128i bytes = _mm_loadu_si128((const __m128i *)pixel);
+      __m128i low = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(bytes, zero), factor), 8);
+      __m128i high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(bytes, zero), factor), 8);
+      _mm_storeu_si128((__m128i *)pixel, _mm_packus_epi16(low, high));
+    }
+  }
+#elif defined(SPAN_NEON)
+  uint8x8_t factor = vdup_n_u8(scale);
+  for (; end - pixel >= 16; pixel += 16) {
+    uint8x16_t bytes = vld1q_u8(pixel);
+    uint8x8_t low = vshrn_n_u16(vmull_u8(vget_low_u8(bytes), factor), 8);
+    uint8x8_t high = vshrn_n_u16(vmull_u8(vget_high_u8(bytes), factor), 8);
+    vst1q_u8(pixel, vcombine_u8(low, high));
+  }
+#elif defined(SPAN_SWAR)
+  for (; (pixel < end) && (0 != ((uintptr_t)pixel & 3)); pixel++) {
+    *pixel = ((uint16_t)*pixel * scale) >> 8;
+  }
+  for (; end - pixel >= 4; pixel += 4) {
+    uint32_t word;
+    memcpy(&word, __builtin_assume_aligned(pixel, 4), 4);
+    // products of 2 bytes at once: 255 * 255 fits into the 16 bits of each half
+    uint32_t even = (((word & 0x00ff00ffUL) * scale) >> 8) & 0x00ff00ffUL;
+    uint32_t odd = (((word >> 8) & 0x00ff00ffUL) * scale) & 0xff00ff00UL;
+    word = even | odd;
+    memcpy(__builtin_assume_aligned(pixel, 4), &word, 4);
+  }
+#endif
+
+  for (; pixel < end; pixel++) {
+    *pixel = ((uint16_t)*pixel * scale) >> 8;
+  }
+}
+
+/*
+ * color order of the LED strip
+ */
+void spanSwizzle(uint8_t *wire, const uint8_t *pixels, const uint8_t rOffset, const uint8_t gOffset, const uint8_t bOffset, const uint16_t count) {
+  const uint8_t *pixel = pixels;
+  const uint8_t *end = pixels + (uint32_t)count * 3;
+
+#if defined(__SSSE3__)
+  // 5 triples per shuffle, the 16th byte is stored, but overwritten by the next shuffle
+  uint8_t order[16];
+  for (uint8_t i=0; i<15; i+=3) {
+    order[i + rOffset] = i;
+    order[i + gOffset] = i + 1;
+    order[i + bOffset] = i + 2;
+  }
+  order[15] = 0x80; // zero
+  __m128i shuffle = _mm_loadu_si128((const __m128i *)order);
+  for (; end - pixel >= 16; pixel += 15, wire += 15) {
+    _mm_storeu_si128((__m128i *)wire, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)pixel), shuffle));
+  }
+#elif defined(SPAN_NEON)
+  for (; end - pixel >= 48; pixel += 48, wire += 48) {
+    uint8x16x3_t rgb = vld3q_u8(pixel);
+    uint8x16x3_t ordered;
+    ordered.val[rOffset] = rgb.val[0];
+    ordered.val[gOffset] = rgb.val[1];
+    ordered.val[bOffset] = rgb.val[2];
+    vst3q_u8(wire, ordered);
+  }
+#endif
+
+  for (; pixel < end; pixel += 3, wire += 3) {
+    wire[rOffset] = pixel[0];
+    wire[gOffset] = pixel[1];
+    wire[bOffset] = pixel[2];
+  }
+}
+
+/*
+ * sums of the channels, e.g. for LEDPixelSink::getIntensity()
+ */
+#if defined(SPAN_NEON)
+static uint32_t sumLanes(const uint16x8_t sums) {
+  uint32x4_t wide = vpaddlq_u16(sums);
+  return vgetq_lane_u32(wide, 0) + vgetq_lane_u32(wide, 1) + vgetq_lane_u32(wide, 2) + vgetq_lane_u32(wide, 3);
+}
+#endif
+
+void spanIntensity(const uint8_t *pixels, const uint16_t count, uint32_t *sums) {
+  const uint8_t *pixel = pixels;
+  const uint8_t *end = pixels + (uint32_t)count * 3;
+
+#if defined(__SSE2__)
+  // 16 bit sums of each of the 48 bytes of a block, byte i belongs to channel i % 3
+  __m128i zero = _mm_setzero_si128();
+  while (end - pixel >= 48) {
+    __m128i byteSums[6] = { zero, zero, zero, zero, zero, zero };
+    // 256 * 255 fits into the 16 bit lanes
+    for (uint16_t block=0; (block < 256) && (end - pixel >= 48); block++, pixel += 48) {
+      for (uint8_t vectorNo=0; vectorNo<3; vectorNo++) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(pixel + 16 * vectorNo));
+        byteSums[2 * vectorNo] = _mm_add_epi16(byteSums[2 * vectorNo], _mm_unpacklo_epi8(bytes, zero));
+        byteSums[2 * vectorNo + 1] = _mm_add_epi16(byteSums[2 * vectorNo + 1], _mm_unpackhi_epi8(bytes, zero));
+      }
+    }
+    uint16_t lanes[48];
+    for (uint8_t vectorNo=0; vectorNo<6; vectorNo++) {
+      _mm_storeu_si128((__m128i *)(lanes + 8 * vectorNo), byteSums[vectorNo]);
+    }
+    for (uint8_t i=0; i<48; i+=3) {
+      sums[0] += lanes[i];
+      sums[1] += lanes[i+1];
+      sums[2] += lanes[i+2];
+    }
+  }
+#elif defined(SPAN_NEON)
+  while (end - pixel >= 48) {
+    uint16x8_t red = vdupq_n_u16(0);
+    uint16x8_t green = vdupq_n_u16(0);
+    uint16x8_t blue = vdupq_n_u16(0);
+    // 128 * 2 * 255 fits into the 16 bit lanes
+    for (uint8_t block=0; (block < 128) && (end - pixel >= 48); block++, pixel += 48) {
+      uint8x16x3_t rgb = vld3q_u8(pixel);
+      red = vpadalq_u8(red, rgb.val[0]);
+      green = vpadalq_u8(green, rgb.val[1]);
+      blue = vpadalq_u8(blue, rgb.val[2]);
+    }
+    sums[0] += sumLanes(red);
+    sums[1] += sumLanes(green);
+    sums[2] += sumLanes(blue);
+  }
+#endif
+
+  for (; pixel < end; pixel += 3) {
+    sums[0] += pixel[0];
+    sums[1] += pixel[1];
+    sums[2] += pixel[2];
+  }
+}
+
+/*
+ * blend of a uniform color into pixels packed into uint32_t
+ */
+void spanBlend32(uint32_t *pixels, const BlendMode mode, const uint32_t color, const uint32_t count) {
+  uint32_t *pixel = pixels;
+  uint32_t *end = pixels + count;
+  uint32_t rgb = color & 0xffffffUL;
+  if ((BlendAdd != mode) && (BlendMax != mode)) {
+    for (; pixel < end; pixel++) {
+      *pixel = rgb;
+    }
+    return;
+  }
+
+#if defined(__AVX2__)
+  {
+    __m256i colors = _mm256_set1_epi32(rgb);
+    for (; end - pixel >= 8; pixel += 8) {
+      _mm256_storeu_si256((__m256i *)pixel, blendAVX2(mode, _mm256_loadu_si256((const __m256i *)pixel), colors));
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    __m128i colors = _mm_set1_epi32(rgb);
+    for (; end - pixel >= 4; pixel += 4) {
+      _mm_storeu_si128((__m128i *)pixel, blendSSE2(mode, _mm_loadu_si128((const __m128i *)pixel), colors));
+    }
+  }
+#elif defined(SPAN_NEON)
+  uint8x16_t colors = vreinterpretq_u8_u32(vdupq_n_u32(rgb));
+  for (; end - pixel >= 4; pixel += 4) {
+    vst1q_u8((uint8_t *)pixel, blendNEON(mode, vld1q_u8((const uint8_t *)pixel), colors));
+  }
+#elif defined(SPAN_SIMD32)
+  for (; pixel < end; pixel++) {
+    *pixel = blendSIMD32(mode, *pixel, rgb);
+  }
+#endif
+
+  uint8_t red   = (rgb >> 16) & 0xff;
+  uint8_t green = (rgb >> 8) & 0xff;
+  uint8_t blue  = rgb & 0xff;
+  for (; pixel < end; pixel++) {
+    uint8_t belowRed   = (*pixel >> 16) & 0xff;
+    uint8_t belowGreen = (*pixel >> 8) & 0xff;
+    uint8_t belowBlue  = *pixel & 0xff;
+    if (BlendAdd == mode) {
+      *pixel = ((uint32_t)addChannel(belowRed, red) << 16) | ((uint32_t)addChannel(belowGreen, green) << 8) | addChannel(belowBlue, blue);
+    }
+    else {
+      *pixel = ((uint32_t)maxChannel(belowRed, red) << 16) | ((uint32_t)maxChannel(belowGreen, green) << 8) | maxChannel(belowBlue, blue);
+    }
+  }
+}
@@ -0,0 +1,45 @@
+// NAME: LEDSpanKernels.h
+//
+// DESC: Kernels for the stages of the composition of a frame, which work on spans of pixels
+//       in packed buffers instead of one PixelColor or uint32_t color at a time.
+//
+//       The buffers hold R-G-B triples like LEDDoubleBufferSink and LEDFrameBufferSink, the
+//       wire buffers of the Adafruit libraries hold the same triples in the color order of
+//       the LED strip, see spanSwizzle(). The pixels of LEDHostRenderer are packed into
+//       uint32_t, see spanBlend32().
+//
+//       Depending on the target, the kernels are compiled with
+//        - AVX2, SSE2 and SSSE3 on x86 hosts (as enabled by the compiler, e.g. -march=native),
+//        - NEON on ARM hosts like the Raspberry Pi (only with USE_ARM_SIMD, see LEDStripTest.h),
+//        - the SIMD32 instructions of the DSP extension on Cortex-M4/M7/M33 (dto.),
+//        - 32 bit SWAR (SIMD within a register) on other 32 bit CPUs like the ESP32,
+//       and a scalar fallback, which also handles the tails of the spans, e.g. on AVR.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDSPANKERNELS_H
+#define LEDSPANKERNELS_H
+
+#include <Arduino.h>
+#include "LEDCluster.h"
+
+// set count pixels to color
+void spanFill(uint8_t *pixels, const uint32_t color, const uint16_t count);
+
+// blend color into count pixels like LEDBlendSink::blend()
+void spanBlend(uint8_t *pixels, const BlendMode mode, const uint32_t color, const uint16_t count);
+
+// scale count pixels with brightness + 1 (1..256) like the Adafruit libraries
+void spanScale(uint8_t *pixels, const uint16_t scale, const uint16_t count);
+
+// copy count pixels into wire order, the offsets are those of red, green and blue in a wire triple
+void spanSwizzle(uint8_t *wire, const uint8_t *pixels, const uint8_t rOffset, const uint8_t gOffset, const uint8_t bOffset, const uint16_t count);
+
+// add the 1st, 2nd and 3rd byte of count triples to sums[0], sums[1] and sums[2]
+void spanIntensity(const uint8_t *pixels, const uint16_t count, uint32_t *sums);
+
+// blend color into count pixels packed into uint32_t
+void spanBlend32(uint32_t *pixels, const BlendMode mode, const uint32_t color, const uint32_t count);
+
+#endif /* LEDSPANKERNELS_H */
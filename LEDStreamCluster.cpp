@@ -0,0 +1,64 @@
+// NAME: LEDStreamCluster.cpp
+//
+// DESC: LEDCluster showing pixels received from a host, see LEDStreamInput.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDStreamCluster.h"
+
+LEDStreamCluster::LEDStreamCluster(const uint16_t length)
+                 :LEDCluster(0) {
+  // replace the (empty) pixels from the arena by dedicated heap blocks, see LEDStreamCluster.h;
+  // ~LEDCluster() frees pixels, as they are not contained in the arena
+  release(pixels, 0);
+  this->length = length;
+  pixels = (PixelColor *)calloc(length, sizeof(PixelColor));
+  staged = (PixelColor *)calloc(length, sizeof(PixelColor));
+  if (NULL == staged) { // not initialized, see isInitialized()
+    free(pixels);
+    pixels = NULL;
+  }
+  stagedStart = stagedEnd = 0;
+}
+
+LEDStreamCluster::~LEDStreamCluster() {
+  free(staged);
+  staged = NULL;
+}
+
+void LEDStreamCluster::beginFrame() {
+  if (stagedStart < stagedEnd) {
+    memcpy(staged + stagedStart, pixels + stagedStart, (stagedEnd - stagedStart) * sizeof(PixelColor));
+  }
+  stagedStart = stagedEnd = 0;
+}
+
+void LEDStreamCluster::receivePixel(const uint16_t no, const uint32_t color) {
+  if (no < length) {
+    staged[no].rgbColor.red   = (color >> 16) & 0xff;
+    staged[no].rgbColor.green = (color >> 8) & 0xff;
+    staged[no].rgbColor.blue  = color & 0xff;
+    if (stagedStart == stagedEnd) {
+      stagedStart = no;
+      stagedEnd = no + 1;
+    }
+    else if (no < stagedStart) stagedStart = no;
+    else if (no >= stagedEnd) stagedEnd = no + 1;
+  }
+}
+
+void LEDStreamCluster::receiveRun(const uint16_t no, const uint16_t count, const uint32_t color) {
+  uint16_t end = ((uint32_t)no + count > length) ? length : no + count;
+  for (uint16_t i=no; i<end; i++) {
+    receivePixel(i, color);
+  }
+}
+
+void LEDStreamCluster::commitFrame() {
+  if (stagedStart < stagedEnd) {
+    memcpy(pixels + stagedStart, staged + stagedStart, (stagedEnd - stagedStart) * sizeof(PixelColor));
+    markDirty(stagedStart, stagedEnd);
+  }
+  stagedStart = stagedEnd = 0;
+}
@@ -0,0 +1,37 @@
+// NAME: LEDStreamCluster.h
+//
+// DESC: LEDCluster showing pixels received from a host, see LEDStreamInput.
+//
+//       The pixels of a message are staged in a second frame buffer while the message is
+//       received, and copied into the shown pixels only when the whole message passed the
+//       CRC check. A message failing the check leaves the shown pixels untouched.
+//
+//       Both frame buffers are dedicated heap blocks of the exact size (3 bytes per pixel,
+//       ARM: 4 bytes) instead of power-of-two blocks of the LEDClusterArena. The cluster is
+//       created once in setup(), so the blocks do not fragment the heap.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDSTREAMCLUSTER_H
+#define LEDSTREAMCLUSTER_H
+
+#include "LEDCluster.h"
+
+class LEDStreamCluster : public LEDCluster {
+private:
+  PixelColor  *staged;        // pixels of the message being received
+  uint16_t    stagedStart;    // range [stagedStart, stagedEnd) of staged pixels differing from pixels
+  uint16_t    stagedEnd;
+
+public:
+  LEDStreamCluster(const uint16_t length);
+  virtual ~LEDStreamCluster();
+
+  void beginFrame();    // drops the staged pixels of a message, which failed the CRC check
+  void receivePixel(const uint16_t no, const uint32_t color);   // stages the pixel
+  void receiveRun(const uint16_t no, const uint16_t count, const uint32_t color);
+  void commitFrame();   // shows the staged pixels with the next frame
+};
+
+#endif /* LEDSTREAMCLUSTER_H */
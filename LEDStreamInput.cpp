@@ -0,0 +1,226 @@
+// NAME: LEDStreamInput.cpp
+//
+// DESC: Receive frames and cluster updates from a host over Serial (or any other Stream).
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDStreamInput.h"
+#include "LEDTrace.h"
+
+LEDStreamInput::LEDStreamInput(LEDClusterController &controller)
+               :controller(controller) {
+  streamHandle = INVALID_CLUSTER_HANDLE;
+  state = WaitSync;
+  stream = NULL;
+  lastByte = 0L;
+  messages = 0L;
+  errors = 0L;
+}
+
+bool LEDStreamInput::begin(const uint8_t layer /* =255 */, const BlendMode mode /* =BlendMax */) {
+  LEDStreamCluster *cluster = new LEDStreamCluster(controller.numPixels());
+  if ((NULL == cluster) || !cluster->isInitialized()) {
+    TRACE(TRACE_ALLOC, TRACE_LEVEL_ERROR, F("LEDStreamInput: out of memory\n"));
+    delete cluster;
+    return false;
+  }
+  cluster->setLayer(layer);
+  cluster->setBlendMode(mode);  // e.g. black pixels of BlendMax leave the clusters below visible
+  streamHandle = controller.addCluster(cluster, 0);
+  if (INVALID_CLUSTER_HANDLE == streamHandle) {
+    delete cluster;
+    return false;
+  }
+  else return true;
+}
+
+bool LEDStreamInput::poll(Stream &input) {
+  if ((WaitSync != state) && (millis() - lastByte > STREAM_TIMEOUT)) { // host gave up within a message
+    errors++;
+    state = WaitSync;
+  }
+
+  bool applied = false;
+  while (input.available() > 0) {
+    if (parse(input.read())) applied = true;
+    lastByte = millis();
+  }
+  return applied;
+}
+
+bool LEDStreamInput::parse(const uint8_t data) {
+  switch (state) {
+    case WaitSync:
+      if (STREAM_SYNC == data) {
+        crc = 0xffff;
+        state = ReadType;
+      }
+      break;
+
+    case ReadType:
+      type = data;
+      crc = updateCRC(crc, data);
+      state = ReadLengthLow;
+      break;
+
+    case ReadLengthLow:
+      length = data;
+      crc = updateCRC(crc, data);
+      state = ReadLengthHigh;
+      break;
+
+    case ReadLengthHigh:
+      length |= (uint16_t)data << 8;
+      crc = updateCRC(crc, data);
+      if (startMessage()) {
+        state = (length > 0) ? ReadPayload : ReadCRCLow;
+      }
+      else {
+        TRACE(TRACE_SCHEDULE, TRACE_LEVEL_ERROR, F("LEDStreamInput: bad message type ") << type << F(" length ") << length << LF);
+        errors++;
+        state = WaitSync;
+      }
+      break;
+
+    case ReadPayload:
+      crc = updateCRC(crc, data);
+      receivePayload(data);
+      if (++received == length) state = ReadCRCLow;
+      break;
+
+    case ReadCRCLow:
+      messageCRC = data;
+      state = ReadCRCHigh;
+      break;
+
+    case ReadCRCHigh:
+      messageCRC |= (uint16_t)data << 8;
+      state = WaitSync;
+      if (messageCRC == crc) {
+        applyMessage();
+        return true;
+      }
+      else {
+        TRACE(TRACE_SCHEDULE, TRACE_LEVEL_ERROR, F("LEDStreamInput: CRC error\n"));
+        errors++;
+      }
+      break;
+  }
+  return false;
+}
+
+/*
+ * check the header of a message and prepare receiving its payload
+ */
+bool LEDStreamInput::startMessage() {
+  received = 0;
+  pixelNo = 0;
+  color = 0L;
+  runLength = 0;
+  stream = NULL;
+
+  switch (type) {
+    case STREAM_FULL_FRAME:
+    case STREAM_RLE_FRAME:
+      if (0 != (length % ((STREAM_FULL_FRAME == type) ? 3 : 4))) return false;
+      stream = (LEDStreamCluster *)controller.getCluster(streamHandle);  // NULL, if not begun or removed
+      if (NULL != stream) stream->beginFrame();
+      return true;
+
+    case STREAM_CLUSTER:
+      return (STREAM_CLUSTER_SIZE == length);
+
+    default:
+      return false;
+  }
+}
+
+/*
+ * stage pixels in the LEDStreamCluster, keep cluster updates until the CRC is checked
+ */
+void LEDStreamInput::receivePayload(const uint8_t data) {
+  switch (type) {
+    case STREAM_FULL_FRAME:
+      color = (color << 8) | data;
+      if (2 == received % 3) {
+        if (NULL != stream) stream->receivePixel(pixelNo, color & 0xffffff);
+        pixelNo++;
+      }
+      break;
+
+    case STREAM_RLE_FRAME:
+      if (0 == received % 4) {
+        runLength = data;
+      }
+      else {
+        color = (color << 8) | data;
+        if (3 == received % 4) {
+          if (NULL != stream) stream->receiveRun(pixelNo, runLength, color & 0xffffff);
+          pixelNo = ((uint32_t)pixelNo + runLength > 0xffff) ? 0xffff : pixelNo + runLength;
+        }
+      }
+      break;
+
+    case STREAM_CLUSTER:
+      record[received] = data;
+      break;
+  }
+}
+
+void LEDStreamInput::applyMessage() {
+  messages++;
+  switch (type) {
+    case STREAM_FULL_FRAME:
+    case STREAM_RLE_FRAME:
+      if (NULL != stream) stream->commitFrame();
+      stream = NULL;
+      break;
+
+    case STREAM_CLUSTER:
+      applyCluster();
+      break;
+  }
+}
+
+void LEDStreamInput::applyCluster() {
+  LEDClusterHandle handle = getValue(record);
+  int32_t value = getValue(record + 5);
+  LEDCluster *cluster = controller.getCluster(handle);
+  if (NULL == cluster) return; // removed meanwhile
+
+  switch (record[4]) {
+    case ParamPosition:
+      cluster->setFixedPosition(value);
+      break;
+    case ParamVelocity:
+      cluster->setVelocity(value);
+      break;
+    case ParamAcceleration:
+      cluster->setAcceleration(value);
+      break;
+    case ParamLayer:
+      controller.setLayer(handle, value);
+      break;
+    case ParamBlendMode:
+      if ((value >= BlendReplace) && (value <= BlendMax)) cluster->setBlendMode((BlendMode)value);
+      break;
+    case ParamColor:
+      for (uint16_t no=0; no<cluster->getLength(); no++) {
+        cluster->setRGBPixel(no, value);
+      }
+      break;
+  }
+}
+
+uint32_t LEDStreamInput::getValue(const uint8_t *bytes) {
+  return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+uint16_t LEDStreamInput::updateCRC(uint16_t crc, const uint8_t data) {
+  crc ^= (uint16_t)data << 8;
+  for (uint8_t bit=0; bit<8; bit++) {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
@@ -0,0 +1,93 @@
+// NAME: LEDStreamInput.h
+//
+// DESC: Receive frames and cluster updates from a host over Serial (or any other Stream).
+//
+//       Every message is framed as
+//         SYNC  TYPE  LENGTH(2)  PAYLOAD(LENGTH)  CRC(2)
+//       with 16 bit values in little endian and CRC-16/CCITT (0x1021, start 0xffff)
+//       over TYPE, LENGTH and PAYLOAD. Message types:
+//         STREAM_FULL_FRAME   R-G-B triples from pixel 0 on
+//         STREAM_RLE_FRAME    runs of COUNT(1) R-G-B from pixel 0 on
+//         STREAM_CLUSTER      HANDLE(4) PARAM(1) VALUE(4) for a cluster of LEDClusterController,
+//                             handles are generation << 16 | slot, i.e. 0x10000 + n for the
+//                             n-th cluster added in setup()
+//       Frames are shown by an LEDStreamCluster on top of the other clusters. A frame
+//       shorter than the LED strip keeps the remaining pixels of the previous frame.
+//
+//       poll() parses all bytes available without blocking. Pixels are staged in the
+//       LEDStreamCluster as they arrive, but only a message with correct CRC is shown
+//       or applied; a dropped frame leaves the shown frame untouched. After an error,
+//       the parser waits for the next SYNC.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDSTREAMINPUT_H
+#define LEDSTREAMINPUT_H
+
+#include <Arduino.h>
+#include "LEDClusterController.h"
+#include "LEDStreamCluster.h"
+
+#define STREAM_SYNC         0xA5
+#define STREAM_FULL_FRAME   0x01
+#define STREAM_RLE_FRAME    0x02
+#define STREAM_CLUSTER      0x03
+
+#define STREAM_CLUSTER_SIZE 9     // payload of STREAM_CLUSTER
+#define STREAM_TIMEOUT      50L   // milliseconds between two bytes of a message, else resync
+
+enum StreamParam {
+  ParamPosition,      // 16.16 fixed-point, see LEDCluster::setFixedPosition()
+  ParamVelocity,      // 16.16 fixed-point pixels per second
+  ParamAcceleration,  // 16.16 fixed-point pixels per second^2
+  ParamLayer,
+  ParamBlendMode,
+  ParamColor          // RGB color of all pixels
+};
+
+class LEDStreamInput {
+private:
+  LEDClusterController &controller;
+  LEDClusterHandle streamHandle;  // LEDStreamCluster showing the frames
+
+  enum ParserState {
+    WaitSync, ReadType, ReadLengthLow, ReadLengthHigh, ReadPayload, ReadCRCLow, ReadCRCHigh
+  } state;
+  uint8_t       type;         // type of current message
+  uint16_t      length;       // length of payload
+  uint16_t      received;     // bytes of payload received
+  uint16_t      crc;          // CRC calculated so far
+  uint16_t      messageCRC;   // CRC sent with the message
+  uint32_t      lastByte;     // time of last byte received in milliseconds
+
+  LEDStreamCluster *stream;   // while a frame is received, else NULL
+  uint16_t      pixelNo;      // next pixel of the frame
+  uint32_t      color;        // color being received
+  uint8_t       runLength;    // length of run being received
+  uint8_t       record[STREAM_CLUSTER_SIZE];  // cluster update, applied after CRC check
+
+  uint32_t      messages;     // messages applied
+  uint32_t      errors;       // messages dropped
+
+  static uint16_t updateCRC(uint16_t crc, const uint8_t data);
+  static uint32_t getValue(const uint8_t *bytes);
+
+  bool startMessage();
+  void receivePayload(const uint8_t data);
+  void applyMessage();
+  void applyCluster();
+
+public:
+  LEDStreamInput(LEDClusterController &controller);
+
+  bool begin(const uint8_t layer = 255, const BlendMode mode = BlendMax); // adds LEDStreamCluster over the LED strip
+  bool poll(Stream &input);       // true, if a message was applied
+  bool parse(const uint8_t data); // true, if a message was applied
+
+  LEDClusterHandle getStreamHandle() const { return streamHandle; }
+  uint32_t getMessages() const  { return messages; }
+  uint32_t getErrors() const    { return errors; }
+};
+
+#endif /* LEDSTREAMINPUT_H */
@@ -19,6 +19,73 @@
 //#define BRG 1
 ///#define BGR 1
 
+/*
+ * Define HSV color conversion here:
+ * 0 calculates colors with ColorHSV() and gamma32() of the Adafruit library,
+ * 256 or 1536 looks up colors in a table with that many hue steps in PROGMEM
+ * (768 or 4608 bytes of flash memory).
+ */
+#ifndef HSV_TABLE_STEPS
+#define HSV_TABLE_STEPS 256
+#endif
+
+/*
+ * Define USE_ARM_SIMD to compile the NEON (ARM hosts) and SIMD32 (Cortex-M4/M7/M33) kernels
+ * of LEDSpanKernels.cpp. They are not built and tested against the scalar kernels yet, so
+ * without it ARM targets use the 32 bit SWAR kernels.
+ */
+//#define USE_ARM_SIMD 1
+
+/*
+ * Define USE_DOUBLE_BUFFER to render into a back buffer in RAM (3 bytes per pixel),
+ * while the previous frame is transmitted. The Adafruit libraries block until the frame
+ * is transmitted, so with them it only serves USE_DITHERING.
+ */
+//#define USE_DOUBLE_BUFFER 1
+
+/*
+ * Define USE_DITHERING (needs USE_DOUBLE_BUFFER) for dithered brightness: the brightness
+ * is applied with temporal dithering, so dim colors keep their hue instead of being
+ * truncated to a few steps. Colors are still composed with 8 bits each.
+ * The LED strip is refreshed with every frame, use it with the fast APA102 (DotStar).
+ */
+//#define USE_DITHERING 1
+
+/*
+ * Define USE_SERIAL_INPUT to receive frames and cluster updates from a host over Serial,
+ * see LEDStreamInput.h. The shown and the staged frame need 3 bytes (ARM: 4 bytes) per pixel
+ * each, allocated from the heap; LEDStripTest.ino stops the build on AVR, if they don't fit.
+ */
+//#define USE_SERIAL_INPUT 1
+
+/*
+ * Define USE_FRAME_STATS to measure the phases of LEDClusterController::show()
+ * and dump the statistics to Serial every STATS_INTERVAL milliseconds.
+ */
+//#define USE_FRAME_STATS 1
+#define STATS_INTERVAL  10000L
+
+/*
+ * Define the power model of the LED strip here: current in mA of one color channel of one pixel
+ * at full intensity, and idle current in mA of one pixel. POWER_BUDGET limits the current of
+ * the whole LED strip in mA by reducing the brightness; 0 for unlimited.
+ */
+#define MILLIAMPS_RED     15
+#define MILLIAMPS_GREEN   15
+#define MILLIAMPS_BLUE    15
+#define MILLIAMPS_IDLE    1
+#define POWER_BUDGET      10000
+
+/*
+ * Define tracing here, see LEDTrace.h:
+ * TRACE_LEVEL is one of TRACE_LEVEL_OFF, _ERROR, _INFO or _DEBUG,
+ * TRACE_CATEGORIES combines TRACE_ALLOC, TRACE_SCHEDULE and TRACE_RENDER (per pixel, very slow!).
+ * Define TRACE_BUFFER_SIZE to collect traces in a ring buffer in RAM, which is flushed in loop().
+ */
+#define TRACE_LEVEL       TRACE_LEVEL_INFO
+#define TRACE_CATEGORIES  (TRACE_ALLOC | TRACE_SCHEDULE)
+//#define TRACE_BUFFER_SIZE 256
+
 /*
  * Do not change
  */
@@ -66,6 +133,7 @@
 
 #define WS2815CONFIG  (COLOR_CONFIG|NEO_KHZ800)
 #define DATA_PIN      11
+//#define DATA_PIN2     12  // optional: second data pin, splits the LED strip into two channels
 
 #else
 #error Either define USE_NEOPIXEL or USE_DOTSTAR
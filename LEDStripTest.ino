@@ -10,9 +10,56 @@
 #include "LEDStripTest.h"
 #include "LEDClusterController.h"
 #include "LEDCluster.h"
+#include "LEDDotStarSink.h"
+#include "LEDDoubleBufferSink.h"
+#include "LEDMultiChannelSink.h"
+#include "LEDNeoPixelSink.h"
+#include "LEDPeakMeter.h"
+#include "LEDPixelSource.h"
+#include "LEDPulsar.h"
+#include "LEDScene.h"
+#include "LEDStreamInput.h"
+#include "LEDTrace.h"
 
 #define NUMPIXELS     1036  //300 //271
-#define MAXCLUSTER    11
+#define CHANNEL1PIXELS 682  // pixels on DATA_PIN, if the LED strip is split into two channels
+#define NUMSEGMENTS   11    // ABSCHNITT segments of stripScene
+
+/*
+ * The arena holds a cluster and its pixels in blocks of their size classes, which differ
+ * between AVR, ARM and 64 bit hosts. Every segment is a uniform LEDCluster with one pixel,
+ * demoScene needs blocks for its 8 clusters. The arena fits the larger of both scenes.
+ */
+#define CLUSTERBYTES(kind, numPixels) (LEDClusterArena::getBlockSize(sizeof(kind)) + LEDClusterArena::getBlockSize((numPixels) * sizeof(PixelColor)))
+#define SEGMENTBYTES  CLUSTERBYTES(LEDCluster, 1)
+#define DEMOBYTES     (CLUSTERBYTES(LEDCluster, 6) + 2 * CLUSTERBYTES(LEDCluster, 1) + CLUSTERBYTES(LEDCluster, 8) + \
+                       2 * CLUSTERBYTES(LEDPulsar, 1) + CLUSTERBYTES(LEDPeakMeter, 20+17) + CLUSTERBYTES(LEDPixelSource, 21))
+#define SCENEBYTES    ((NUMSEGMENTS * SEGMENTBYTES > DEMOBYTES) ? NUMSEGMENTS * SEGMENTBYTES : DEMOBYTES)
+#ifdef USE_SERIAL_INPUT
+#define MAXCLUSTER    (NUMSEGMENTS + 1)
+#define ARENASIZE     (SCENEBYTES + LEDClusterArena::getBlockSize(sizeof(LEDStreamCluster)) + ARENA_MIN_BLOCK_SIZE) // incl. LEDStreamCluster and its empty pixels
+#define STREAMBYTES   (2L * 3 * NUMPIXELS) // shown and staged frame of LEDStreamCluster, on the heap
+#else
+#define MAXCLUSTER    NUMSEGMENTS
+#define ARENASIZE     SCENEBYTES           // bytes of memory for clusters and their pixels
+#define STREAMBYTES   0L
+#endif
+#ifdef USE_DOUBLE_BUFFER
+#define BUFFERBYTES   (3L * NUMPIXELS)     // back buffer of LEDDoubleBufferSink
+#else
+#define BUFFERBYTES   0L
+#endif
+
+/*
+ * On AVR the LED strip, the arena, the frames of LEDStreamCluster and the back buffer are
+ * allocated from the SRAM at once, leave RAMRESERVE bytes for stack and globals.
+ * ARENASIZE depends on sizeof(), so the compiler checks it instead of the preprocessor.
+ */
+#define RAMRESERVE    1024
+#if defined(__AVR__) && defined(RAMEND) && defined(RAMSTART)
+static_assert(3L * NUMPIXELS + ARENASIZE + STREAMBYTES + BUFFERBYTES + RAMRESERVE <= RAMEND - RAMSTART + 1,
+              "NUMPIXELS too long for the SRAM of this board with USE_SERIAL_INPUT or USE_DOUBLE_BUFFER");
+#endif
 
 #define RELAIS_PIN    5   // optional: pin for relais to turn on/off power to LED strip
 
@@ -22,12 +69,83 @@
  * Mega: 51 for data, 52 for clock
  */
 #ifdef USE_DOTSTAR
-LEDClusterController ledController(NUMPIXELS, APA102CONFIG, MAXCLUSTER);
+LEDDotStarSink ledStrip(NUMPIXELS, APA102CONFIG);
+#elif defined(DATA_PIN2)
+LEDNeoPixelSink ledChannel1(CHANNEL1PIXELS, DATA_PIN, WS2815CONFIG);
+LEDNeoPixelSink ledChannel2(NUMPIXELS-CHANNEL1PIXELS, DATA_PIN2, WS2815CONFIG);
+LEDPixelSink *ledChannels[] = { &ledChannel1, &ledChannel2 };
+LEDMultiChannelSink ledStrip(ledChannels, 2);
 #elif USE_NEOPIXEL
-LEDClusterController ledController(NUMPIXELS, DATA_PIN, WS2815CONFIG, MAXCLUSTER);
+LEDNeoPixelSink ledStrip(NUMPIXELS, DATA_PIN, WS2815CONFIG);
 #else
 #error Either define USE_NEOPIXEL or USE_DOTSTAR
 #endif
+#ifdef USE_DOUBLE_BUFFER
+LEDDoubleBufferSink ledBuffer(ledStrip);
+LEDClusterController ledController(ledBuffer, MAXCLUSTER, ARENASIZE);
+#else
+LEDClusterController ledController(ledStrip, MAXCLUSTER, ARENASIZE);
+#endif
+#ifdef USE_SERIAL_INPUT
+LEDStreamInput ledInput(ledController);
+#endif
+
+/*
+ * segments of the LED strip, each shown in one color
+ */
+#define ABSCHNITT_A 73
+#define ABSCHNITT_B 86
+#define ABSCHNITT_C 171
+#define ABSCHNITT_D 86
+#define ABSCHNITT_E 84
+#define ABSCHNITT_F 171
+#define ABSCHNITT_G 11
+#define ABSCHNITT_H 38
+#define ABSCHNITT_I 172
+#define ABSCHNITT_J 39
+#define ABSCHNITT_K 105
+
+const uint8_t stripScene[] PROGMEM = {
+  SCENE_RGB_PIXEL(COLOR_RED,     ABSCHNITT_G, CHANNEL1PIXELS-ABSCHNITT_G),
+  SCENE_RGB_PIXEL(COLOR_RED,     ABSCHNITT_A, 0),
+  SCENE_RGB_PIXEL(COLOR_GREEN,   ABSCHNITT_B, ABSCHNITT_A),
+  SCENE_RGB_PIXEL(COLOR_BLUE,    ABSCHNITT_C, ABSCHNITT_A+ABSCHNITT_B),
+  SCENE_RGB_PIXEL(COLOR_RED,     ABSCHNITT_D, ABSCHNITT_A+ABSCHNITT_B+ABSCHNITT_C),
+  SCENE_RGB_PIXEL(COLOR_GREEN,   ABSCHNITT_E, ABSCHNITT_A+ABSCHNITT_B+ABSCHNITT_C+ABSCHNITT_D),
+  SCENE_RGB_PIXEL(COLOR_BLUE,    ABSCHNITT_F, ABSCHNITT_A+ABSCHNITT_B+ABSCHNITT_C+ABSCHNITT_D+ABSCHNITT_E),
+  SCENE_RGB_PIXEL(COLOR_YELLOW,  ABSCHNITT_H, CHANNEL1PIXELS),
+  SCENE_RGB_PIXEL(COLOR_CYAN,    ABSCHNITT_I, CHANNEL1PIXELS+ABSCHNITT_H),
+  SCENE_RGB_PIXEL(COLOR_MAGENTA, ABSCHNITT_J, CHANNEL1PIXELS+ABSCHNITT_H+ABSCHNITT_I),
+  SCENE_RGB_PIXEL(COLOR_WHITE,   ABSCHNITT_K, CHANNEL1PIXELS+ABSCHNITT_H+ABSCHNITT_I+ABSCHNITT_J),
+  SCENE_END
+};
+
+/*
+ * moving clusters of all kinds, load it instead of stripScene for testing; keep DEMOBYTES
+ * in line with its clusters
+ */
+const uint8_t demoScene[] PROGMEM = {
+  SCENE_RGB_RAINBOW(6, (NUMPIXELS-6)/2),
+  SCENE_RGB_PIXEL(COLOR_RED, 1, 0),
+    SCENE_MOVE(LtR, 1000L),
+    SCENE_BACK_AND_FORTH,
+  SCENE_RGB_PIXEL(COLOR_BLUE, 5, NUMPIXELS-1),
+    SCENE_MOVE(RtL, 0L),
+    SCENE_WRAP_AROUND,
+  SCENE_RGB_PATTERN(COLOR_GREEN, 0b11010101, 0),
+    SCENE_MOVE(LtR, 500L),
+    SCENE_START(0L, 10000L),
+  SCENE_PULSAR_PIXEL(0, 1, 1, 0),
+    SCENE_MOVE(LtR, 750L),
+    SCENE_WRAP_AROUND,
+  SCENE_PULSAR_PIXEL(0, 1, 3, NUMPIXELS-1),
+    SCENE_MOVE(RtL, 300L),
+    SCENE_WRAP_AROUND,
+  SCENE_PEAK_METER(20, 17, 0),
+    SCENE_MOVE(NoD, 50L),
+  SCENE_PIXEL_SOURCE(21, 0, 0),
+  SCENE_END
+};
 
 void setup() {
   Serial.begin(115200);
@@ -39,6 +157,8 @@ void setup() {
   Serial << F("Free Memory at Start: ") << initialFreeMemory << F(" bytes\n");
 #ifdef USE_DOTSTAR
   Serial << F("Uses Adafruit_DotStar: Data pin 11, Clock pin 13\n");
+#elif defined(DATA_PIN2)
+  Serial << F("Uses Adafruit_NeoPixel: Data pins ") << DATA_PIN << F(" and ") << DATA_PIN2 << LF;
 #elif USE_NEOPIXEL
   Serial << F("Uses Adafruit_NeoPixel: Data pin 11, opt. Backup pin 11\n");
 #else
@@ -50,158 +170,57 @@ void setup() {
   digitalWrite(RELAIS_PIN, HIGH);
   delay(100);
 
+#ifdef USE_DITHERING
+  ledBuffer.setDithering(true);
+#endif
+  ledController.setPowerBudget(POWER_BUDGET);
   ledController.begin();  // first 3 LEDs should be R-G-B
   delay(1000);
 
-/*
-  LEDCluster *cluster1 = LEDCluster::initRGBRainbow(6);
-  if (NULL != cluster1) {
-    ledController.addCluster(cluster1, (NUMPIXELS-6)/2);
-    Serial << F("Free Memory with Cluster1: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-  LEDCluster *cluster2 = LEDCluster::initRGBPixel(COLOR_RED);
-  if (NULL != cluster2) {
-    cluster2->setDirection(LtR);
-    cluster2->enableBackAndForth();
-    cluster2->setUpdateInterval(1000L);
-    ledController.addCluster(cluster2, 0);
-    Serial << F("Free Memory with Cluster2: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-  LEDCluster *cluster3 = LEDCluster::initRGBBar(COLOR_BLUE, 5);
-  if (NULL != cluster3) {
-    cluster3->setDirection(RtL);
-    cluster3->enableWrapAround();
-    ledController.addCluster(cluster3, NUMPIXELS-1);
-    Serial << F("Free Memory with Cluster3: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
+  uint16_t numClusters = ledController.loadScene(stripScene);
+  Serial << F("Clusters loaded: ") << numClusters << LF;
 
-  LEDCluster *cluster4 = LEDCluster::initRGBPattern(COLOR_GREEN, 0b11010101);
-  if (NULL != cluster4) {
-    cluster4->setDirection(LtR);
-    cluster4->setUpdateInterval(500L);
-    cluster4->setStartInterval(10000L);
-    ledController.addCluster(cluster4, 0);
-    Serial << F("Free Memory with Cluster4: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-  LEDCluster *cluster5 = LEDCluster::initPulsarPixel(0, 1);
-  if (NULL != cluster5) {
-    cluster5->setDirection(LtR);
-    cluster5->setUpdateInterval(750L);
-    cluster5->enableWrapAround();
-    ledController.addCluster(cluster5);
-    Serial << F("Free Memory with Cluster5: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-  LEDCluster *cluster6 = LEDCluster::initPulsarBar(0, 1, 3);
-  if (NULL != cluster6) {
-    cluster6->setDirection(RtL);
-    cluster6->enableWrapAround();
-    cluster6->setUpdateInterval(300L);
-    ledController.addCluster(cluster6, NUMPIXELS-1);
-    Serial << F("Free Memory with Cluster6: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-  LEDCluster *cluster7 = LEDCluster::initPeakMeter(20, 17);
-  if (NULL != cluster7) {
-    cluster7->setUpdateInterval(50L);
-    ledController.addCluster(cluster7, 0);
-    Serial << F("Free Memory with Cluster7: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-
-  LEDCluster *cluster8 = LEDCluster::initPixelSource(21, 0);
-  if (NULL != cluster8) {
-    ledController.addCluster(cluster8, 0);
-    Serial << F("Free Memory with Cluster8: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-*/
-
-#define ABSCHNITT_A 73
-#define ABSCHNITT_B 86
-#define ABSCHNITT_C 171
-#define ABSCHNITT_D 86
-#define ABSCHNITT_E 84
-#define ABSCHNITT_F 171
-#define ABSCHNITT_G 11
-#define ABSCHNITT_H 38
-#define ABSCHNITT_I 172
-#define ABSCHNITT_J 39
-#define ABSCHNITT_K 105
-
-  LEDCluster *cluster0 = LEDCluster::initRGBPixel(COLOR_RED, ABSCHNITT_G);
-  if (NULL != cluster0) {
-    ledController.addCluster(cluster0, 682-ABSCHNITT_G);
-    Serial << F("Free Memory with Cluster0: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-  LEDCluster *cluster1 = LEDCluster::initRGBPixel(COLOR_RED, ABSCHNITT_A);
-  if (NULL != cluster1) {
-    ledController.addCluster(cluster1, 0);
-    Serial << F("Free Memory with Cluster1: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-  LEDCluster *cluster2 = LEDCluster::initRGBPixel(COLOR_GREEN, ABSCHNITT_B);
-  if (NULL != cluster2) {
-    ledController.addCluster(cluster2, ABSCHNITT_A);
-    Serial << F("Free Memory with Cluster2: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-  LEDCluster *cluster3 = LEDCluster::initRGBPixel(COLOR_BLUE, ABSCHNITT_C);
-  if (NULL != cluster3) {
-    ledController.addCluster(cluster3, ABSCHNITT_A+ABSCHNITT_B);
-    Serial << F("Free Memory with Cluster3: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-  LEDCluster *cluster4 = LEDCluster::initRGBPixel(COLOR_RED, ABSCHNITT_D);
-  if (NULL != cluster4) {
-    ledController.addCluster(cluster4, ABSCHNITT_A+ABSCHNITT_B+ABSCHNITT_C);
-    Serial << F("Free Memory with Cluster4: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-  LEDCluster *cluster5 = LEDCluster::initRGBPixel(COLOR_GREEN, ABSCHNITT_E);
-  if (NULL != cluster5) {
-    ledController.addCluster(cluster5, ABSCHNITT_A+ABSCHNITT_B+ABSCHNITT_C+ABSCHNITT_D);
-    Serial << F("Free Memory with Cluster5: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-  LEDCluster *cluster6 = LEDCluster::initRGBPixel(COLOR_BLUE, ABSCHNITT_F);
-  if (NULL != cluster6) {
-    ledController.addCluster(cluster6, ABSCHNITT_A+ABSCHNITT_B+ABSCHNITT_C+ABSCHNITT_D+ABSCHNITT_E);
-    Serial << F("Free Memory with Cluster6: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-  LEDCluster *cluster7 = LEDCluster::initRGBPixel(COLOR_YELLOW, ABSCHNITT_H);
-  if (NULL != cluster7) {
-    ledController.addCluster(cluster7, 682);
-    Serial << F("Free Memory with Cluster7: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-  LEDCluster *cluster8 = LEDCluster::initRGBPixel(COLOR_CYAN, ABSCHNITT_I);
-  if (NULL != cluster8) {
-    ledController.addCluster(cluster8, 682+ABSCHNITT_H);
-    Serial << F("Free Memory with Cluster8: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-  LEDCluster *cluster9 = LEDCluster::initRGBPixel(COLOR_MAGENTA, ABSCHNITT_J);
-  if (NULL != cluster9) {
-    ledController.addCluster(cluster9, 682+ABSCHNITT_H+ABSCHNITT_I);
-    Serial << F("Free Memory with Cluster9: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
-  }
-
-  LEDCluster *cluster10 = LEDCluster::initRGBPixel(COLOR_WHITE, ABSCHNITT_K);
-  if (NULL != cluster10) {
-    ledController.addCluster(cluster10, 682+ABSCHNITT_H+ABSCHNITT_I+ABSCHNITT_J);
-    Serial << F("Free Memory with Cluster10: ") << TrappmannRobotics::getFreeMemory() << F(" bytes\n");
+#ifdef USE_SERIAL_INPUT
+  if (ledInput.begin()) {
+    Serial << F("Receiving frames on Serial\n");
   }
+#endif
 
   uint32_t freeMemory = TrappmannRobotics::getFreeMemory();
   Serial << F("Used Memory: ") << (initialFreeMemory - freeMemory) << LF;
+  Serial << F("Free Cluster Memory: ") << ledController.getArena().getFreeBytes() << F(" of ") << ledController.getArena().getCapacity() << F(" bytes\n");
   delay(1000);
 }
 
 unsigned long lastMinute = 0L;
+#ifdef USE_FRAME_STATS
+unsigned long lastStats = 0L;
+#endif
 void loop() {
   ledController.show();
+  LEDTrace::flushToSerial();
+
+#ifdef USE_FRAME_STATS
+  // dump frame statistics every STATS_INTERVAL
+  if (millis() - lastStats >= STATS_INTERVAL) {
+    if (0L == lastStats) LEDFrameStats::printCSVHeader();
+    ledController.getStats().printCSV();
+    ledController.getStats().reset();
+    lastStats = millis();
+  }
+#endif
+
+  // sleep until the next cluster is due, but wake up in time for the next flash
+  uint32_t idleTime = ledController.getIdleTime();
+  uint32_t flashTime = (lastMinute + 1) * 60000L - millis();
+  if (flashTime < idleTime) idleTime = flashTime;
+#ifdef USE_SERIAL_INPUT
+  // keep receiving while idle, show a received message at once
+  uint32_t idleStart = millis();
+  while (!ledInput.poll(Serial) && (millis() - idleStart < idleTime)) yield();
+#else
+  if ((int32_t)idleTime > 0L) delay(idleTime);
+#endif
 
   // flash all LEDs every 60secs
   unsigned long minute = millis() / 60000L;
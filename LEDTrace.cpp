@@ -0,0 +1,45 @@
+// NAME: LEDTrace.cpp
+//
+// DESC: Leveled tracing by category, configured at compile time in LEDStripTest.h.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDTrace.h"
+
+#ifdef TRACE_BUFFER_SIZE
+
+LEDTrace LEDTrace::ringBuffer;
+
+LEDTrace::LEDTrace() {
+  head = 0;
+  tail = 0;
+  dropped = 0;
+}
+
+size_t LEDTrace::write(uint8_t c) {
+  uint16_t next = (head + 1) % TRACE_BUFFER_SIZE;
+  if (next == tail) { // full
+    if (dropped < 0xffff) dropped++;
+    return 0;
+  }
+  buffer[head] = c;
+  head = next;
+  return 1;
+}
+
+void LEDTrace::flushToSerial() {
+  LEDTrace &trace = ringBuffer;
+  int space = Serial.availableForWrite();
+  while ((space > 0) && (trace.tail != trace.head)) {
+    Serial.write(trace.buffer[trace.tail]);
+    trace.tail = (trace.tail + 1) % TRACE_BUFFER_SIZE;
+    space--;
+  }
+  if ((trace.dropped > 0) && (trace.tail == trace.head) && (space >= 24)) {
+    Serial << F("[trace dropped ") << trace.dropped << F("]\n");
+    trace.dropped = 0;
+  }
+}
+
+#endif /* TRACE_BUFFER_SIZE */
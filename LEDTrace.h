@@ -0,0 +1,79 @@
+// NAME: LEDTrace.h
+//
+// DESC: Leveled tracing by category, configured at compile time in LEDStripTest.h.
+//
+//       TRACE(category, level, msg) streams msg like SEROUT(), but only if the category is
+//       enabled in TRACE_CATEGORIES and level is not above TRACE_LEVEL. Disabled traces are
+//       removed by the compiler, so per pixel tracing in the render path costs nothing,
+//       unless TRACE_RENDER is enabled explicitly.
+//
+//       If TRACE_BUFFER_SIZE is defined, traces are written into a ring buffer in RAM
+//       instead of Serial, and LEDTrace::flushToSerial() moves them to Serial as far as
+//       this is possible without blocking. Traces, which do not fit in the ring buffer,
+//       are dropped and counted.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDTRACE_H
+#define LEDTRACE_H
+
+#include <Arduino.h>
+#include <TrappmannRobotics.h>
+#include "LEDStripTest.h"
+
+/*
+ * trace levels
+ */
+#define TRACE_LEVEL_OFF     0
+#define TRACE_LEVEL_ERROR   1   // failures, e.g. out of memory
+#define TRACE_LEVEL_INFO    2   // life cycle of clusters
+#define TRACE_LEVEL_DEBUG   3   // details
+
+/*
+ * trace categories, may be combined
+ */
+#define TRACE_ALLOC     0x01  // allocation and deletion of clusters and memory
+#define TRACE_SCHEDULE  0x02  // adding, restarting and removing of clusters, flashes
+#define TRACE_RENDER    0x04  // per pixel access while rendering (hot path!)
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL       TRACE_LEVEL_OFF
+#endif
+#ifndef TRACE_CATEGORIES
+#define TRACE_CATEGORIES  (TRACE_ALLOC | TRACE_SCHEDULE)
+#endif
+
+#if TRACE_LEVEL > TRACE_LEVEL_OFF
+#define TRACE(category, level, msg) \
+  do { if (((category) & TRACE_CATEGORIES) && ((level) <= TRACE_LEVEL)) { LEDTrace::out() << msg; } } while (false)
+#else
+#define TRACE(category, level, msg)
+#endif
+
+class LEDTrace : public Print {
+#ifdef TRACE_BUFFER_SIZE
+private:
+  uint8_t   buffer[TRACE_BUFFER_SIZE];  // ring buffer of trace output
+  uint16_t  head;                       // next byte to write
+  uint16_t  tail;                       // next byte to flush
+  uint16_t  dropped;                    // bytes dropped, because the ring buffer was full
+
+  static LEDTrace ringBuffer;
+
+  LEDTrace();
+
+public:
+  virtual size_t write(uint8_t c);
+  using Print::write;
+
+  static Print &out() { return ringBuffer; }
+  static void flushToSerial();  // move buffered traces to Serial without blocking
+#else
+public:
+  static Print &out() { return Serial; }
+  static void flushToSerial() {}
+#endif
+};
+
+#endif /* LEDTRACE_H */
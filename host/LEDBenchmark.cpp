@@ -0,0 +1,180 @@
+// NAME: LEDBenchmark.cpp
+//
+// DESC: Host benchmark of LEDClusterController::show() for strip lengths and mixes of clusters.
+//
+//       Every scenario runs like loop() of the sketch for some virtual seconds: show(), then
+//       sleep until the next cluster is due. Reported are the host time of show() per call
+//       (ns/frame), the frames transmitted per virtual second (fps) and the heap allocated
+//       for the LED strip, the controller and its clusters.
+//
+//       LEDBenchmarkStats is built with USE_FRAME_STATS: the difference of ns/frame is the
+//       overhead of LEDFrameStats. It checks, that every frame transmitted was counted, and
+//       every STATS_TIMED_FRAMES frames one was timed.
+//
+//       usage: LEDBenchmark [seconds [numPixels]]   (default 10 seconds, all strip lengths)
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <chrono>
+
+#include "LEDClusterController.h"
+#include "LEDCluster.h"
+#include "LEDColor.h"
+#include "LEDNeoPixelSink.h"
+
+#define BENCHMARK_ARENA_SIZE  32768
+
+typedef void (*ClusterMix)(LEDClusterController &controller);
+
+static int failures = 0;
+
+/*
+ * 11 static segments in one color each like the ABSCHNITT segments of LEDStripTest.ino
+ */
+static void addSegments(LEDClusterController &controller) {
+  static const uint32_t colors[] = { COLOR_RED, COLOR_GREEN, COLOR_BLUE, COLOR_YELLOW, COLOR_CYAN, COLOR_MAGENTA, COLOR_WHITE };
+  uint16_t numPixels = controller.numPixels();
+  for (uint16_t segmentNo=0; segmentNo<11; segmentNo++) {
+    uint16_t start = (uint32_t)numPixels * segmentNo / 11;
+    uint16_t end = (uint32_t)numPixels * (segmentNo + 1) / 11;
+    controller.addCluster(LEDCluster::initRGBPixel(colors[segmentNo % 7], end - start), start);
+  }
+}
+
+/*
+ * moving clusters of all kinds, one per 20 pixels
+ */
+static void addMoving(LEDClusterController &controller) {
+  randomSeed(1);
+  uint16_t numClusters = controller.numPixels() / 20;
+  for (uint16_t clusterNo=0; clusterNo<numClusters; clusterNo++) {
+    LEDCluster *cluster = NULL;
+    switch (clusterNo % 4) {
+      case 0:
+        cluster = LEDCluster::initRGBPixel(random(0x1000000L), 1 + random(20));
+        break;
+      case 1:
+        cluster = LEDCluster::initRGBRainbow(6 + random(60));
+        break;
+      case 2:
+        cluster = LEDCluster::initRGBPattern(random(0x1000000L), random(256));
+        break;
+      case 3:
+        cluster = LEDCluster::initPulsarPixel(random(0x10000L), 1 + random(8), 1 + random(10));
+        break;
+    }
+    if (NULL == cluster) continue;
+
+    cluster->setDirection(random(2) ? LtR : RtL);
+    cluster->setUpdateInterval(20 + random(200));
+    cluster->enableWrapAround();
+    cluster->setLayer(random(4));
+    cluster->setBlendMode((BlendMode)random(3));
+    controller.addCluster(cluster, random(controller.numPixels()));
+  }
+}
+
+/*
+ * animated clusters: pixel sources and peak meters, one per 50 pixels
+ */
+static void addSources(LEDClusterController &controller) {
+  randomSeed(2);
+  uint16_t numClusters = controller.numPixels() / 50;
+  for (uint16_t clusterNo=0; clusterNo<numClusters; clusterNo++) {
+    LEDCluster *cluster = (clusterNo & 1) ? LEDCluster::initPeakMeter(20, 3) : LEDCluster::initPixelSource(21, random(0x10000L));
+    if (NULL == cluster) continue;
+    controller.addCluster(cluster, (uint32_t)clusterNo * controller.numPixels() / numClusters);
+  }
+}
+
+/*
+ * a static rainbow over the whole strip like the background clusters of a scene, and small
+ * moving pixels on top of it, one per 20 pixels
+ */
+static void addBackground(LEDClusterController &controller) {
+  randomSeed(3);
+  uint16_t numPixels = controller.numPixels();
+  controller.addCluster(LEDCluster::initRGBRainbow(numPixels), 0);
+  for (uint16_t clusterNo=0; clusterNo<numPixels/20; clusterNo++) {
+    LEDCluster *cluster = LEDCluster::initRGBPixel(random(0x1000000L), 1 + random(5));
+    if (NULL == cluster) continue;
+    cluster->setDirection(random(2) ? LtR : RtL);
+    cluster->setUpdateInterval(20 + random(200));
+    cluster->enableWrapAround();
+    cluster->setLayer(1);
+    cluster->setBlendMode(BlendMax);
+    controller.addCluster(cluster, random(numPixels));
+  }
+}
+
+static const struct {
+  const char  *name;
+  ClusterMix  addClusters;
+} clusterMixes[] = {
+  { "segments", addSegments },
+  { "moving",   addMoving },
+  { "sources",  addSources },
+  { "background", addBackground }
+};
+
+static void runScenario(const uint16_t numPixels, const uint8_t mixNo, const uint32_t seconds) {
+  HostArduino::setTime(0);
+  size_t heapAtStart = HostArduino::getHeapInUse();
+  LEDNeoPixelSink *strip = new LEDNeoPixelSink(numPixels, DATA_PIN, WS2815CONFIG);
+  LEDClusterController *controller = new LEDClusterController(*strip, 255, BENCHMARK_ARENA_SIZE);
+  controller->setPowerBudget(POWER_BUDGET);
+  controller->begin();
+  clusterMixes[mixNo].addClusters(*controller);
+  size_t heap = HostArduino::getHeapInUse() - heapAtStart;
+
+  uint32_t calls = 0;
+  uint32_t showCount = Adafruit_NeoPixel::getTotalShowCount();
+  uint32_t stopTime = seconds * 1000;
+  std::chrono::steady_clock::duration showTime = std::chrono::steady_clock::duration::zero();
+  while (millis() < stopTime) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    controller->show();
+    showTime += std::chrono::steady_clock::now() - start;
+    calls++;
+
+    uint32_t idleTime = controller->getIdleTime();
+    if (idleTime > stopTime - millis()) idleTime = stopTime - millis();
+    delay((idleTime > 0) ? idleTime : 1);
+  }
+  uint32_t frames = Adafruit_NeoPixel::getTotalShowCount() - showCount;
+  double ns = std::chrono::duration<double, std::nano>(showTime).count() / calls;
+#ifdef USE_FRAME_STATS
+  const LEDFrameStats &stats = controller->getStats();
+  if ((stats.getFrames() != frames) || (stats.getTimedFrames() != (frames + STATS_TIMED_FRAMES - 1) / STATS_TIMED_FRAMES)) {
+    printf("%s %u: %u frames counted, %u timed, %u transmitted\n", clusterMixes[mixNo].name, numPixels, stats.getFrames(), stats.getTimedFrames(), frames);
+    failures++;
+  }
+#endif
+
+  printf("%-10s %6u %8u %7u %7u %10.0f %8.1f %8u\n", clusterMixes[mixNo].name, numPixels, controller->getNumClusters(),
+    calls, frames, ns, (double)frames / seconds, (unsigned)heap);
+
+  delete controller;
+  delete strip;
+}
+
+int main(int argc, char *argv[]) {
+  static const uint16_t stripLengths[] = { 60, 300, 1036, 4096 };
+  uint32_t seconds = (argc > 1) ? strtoul(argv[1], NULL, 0) : 10;
+  uint16_t numPixels = (argc > 2) ? strtoul(argv[2], NULL, 0) : 0;
+  if (0 == seconds) return 1;
+
+  HostArduino::setSerialOutput(NULL);
+  printf("%-10s %6s %8s %7s %7s %10s %8s %8s\n", "mix", "pixels", "clusters", "calls", "frames", "ns/frame", "fps", "heap");
+  for (uint8_t mixNo=0; mixNo<sizeof(clusterMixes)/sizeof(clusterMixes[0]); mixNo++) {
+    if (0 != numPixels) {
+      runScenario(numPixels, mixNo, seconds);
+      continue;
+    }
+    for (uint8_t lengthNo=0; lengthNo<sizeof(stripLengths)/sizeof(stripLengths[0]); lengthNo++) {
+      runScenario(stripLengths[lengthNo], mixNo, seconds);
+    }
+  }
+  return failures;
+}
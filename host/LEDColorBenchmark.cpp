@@ -0,0 +1,45 @@
+// NAME: LEDColorBenchmark.cpp
+//
+// DESC: Host benchmark of gammaColorHSV(), see LEDColor.h, against the path of the Adafruit
+//       library gamma32(ColorHSV()), which it replaces: ns per color of both and the error
+//       of gammaColorHSV() per color channel over all hues and saturations.
+//
+//       host/CMakeLists.txt builds it for every HSV_TABLE_STEPS: LEDColorBenchmark with the
+//       configuration of LEDStripTest.h, LEDColorBenchmark0 and LEDColorBenchmark1536.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <chrono>
+
+#include "LEDColor.h"
+#include "LEDColorError.h"
+
+/*
+ * ns per color of convert over hues and saturations
+ */
+template<class Convert> static double measure(Convert convert) {
+  uint32_t sum = 0L;
+  uint32_t colors = 0L;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::duration elapsed;
+  do {
+    for (uint32_t hue=0; hue<0x10000L; hue+=97) {
+      sum += convert(hue, 255 - (hue & 0x3f));
+      colors++;
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(200));
+  asm volatile("" :: "r"(sum));
+  return std::chrono::duration<double, std::nano>(elapsed).count() / colors;
+}
+
+int main() {
+  printf("HSV_TABLE_STEPS %u\n", HSV_TABLE_STEPS);
+  printf("%-24s %8.2f ns/color\n", "gamma32(ColorHSV())", measure([](uint16_t hue, uint8_t saturation) { return libraryColorHSV(hue, saturation); }));
+  printf("%-24s %8.2f ns/color\n", "gammaColorHSV()", measure([](uint16_t hue, uint8_t saturation) { return gammaColorHSV(hue, saturation); }));
+
+  ColorError error = compareColorHSV(1, 1);
+  printf("error per channel: max %u, mean %.3f over %u colors\n", error.maxError, (double)error.sumError / error.channels, error.channels / 3);
+  return 0;
+}
@@ -0,0 +1,54 @@
+// NAME: LEDColorError.h
+//
+// DESC: Error of gammaColorHSV() against gamma32(ColorHSV()) of the Adafruit library for
+//       LEDColorBenchmark and LEDTestColor.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDCOLORERROR_H
+#define LEDCOLORERROR_H
+
+#include "LEDColor.h"
+
+struct ColorError {
+  uint8_t   maxError;     // largest difference of a color channel
+  uint32_t  sumError;     // sum of the differences of all channels compared
+  uint32_t  channels;     // color channels compared
+};
+
+static inline uint32_t libraryColorHSV(const uint16_t hue, const uint8_t saturation, const uint8_t value = 255) {
+#ifdef USE_DOTSTAR
+  return Adafruit_DotStar::gamma32(Adafruit_DotStar::ColorHSV(hue, saturation, value));
+#else
+  return Adafruit_NeoPixel::gamma32(Adafruit_NeoPixel::ColorHSV(hue, saturation, value));
+#endif
+}
+
+/*
+ * all hues and saturations in steps of hueStep and saturationStep,
+ * values down from full value in steps of valueStep (by default full value only)
+ */
+static inline ColorError compareColorHSV(const uint16_t hueStep, const uint8_t saturationStep, const uint16_t valueStep = 256) {
+  ColorError error = { 0, 0L, 0L };
+  for (uint32_t hue=0; hue<0x10000L; hue+=hueStep) {
+    for (uint16_t saturation=255; saturation<256; saturation-=saturationStep) {
+      for (uint16_t value=255; value<256; value-=valueStep) {
+        uint32_t expected = libraryColorHSV(hue, saturation, value);
+        uint32_t actual = gammaColorHSV(hue, saturation, value);
+        for (uint8_t shift=0; shift<24; shift+=8) {
+          int16_t difference = (int16_t)((expected >> shift) & 0xff) - (int16_t)((actual >> shift) & 0xff);
+          uint8_t channelError = (difference < 0) ? -difference : difference;
+          if (channelError > error.maxError) error.maxError = channelError;
+          error.sumError += channelError;
+          error.channels++;
+        }
+        if (value < valueStep) break;
+      }
+      if (saturation < saturationStep) break;
+    }
+  }
+  return error;
+}
+
+#endif /* LEDCOLORERROR_H */
@@ -0,0 +1,81 @@
+// NAME: LEDFrameCostBenchmark.cpp
+//
+// DESC: Host benchmark of the cost of a frame against the length of the LED strip: 11 moving
+//       clusters of 20 pixels each like the segments of the installation, on strips from 60
+//       to 4096 pixels. The clusters cover the same number of pixels on every strip, so the
+//       cost of show() should not grow with the strip, only with the pixels lit.
+//
+//       The benchmark uses only the API of LEDCluster and LEDClusterController, which the
+//       sketch had from the beginning. With HOST_BASELINE it compiles against the controller
+//       deriving from Adafruit_NeoPixel, so older revisions can be measured, see BASELINE_DIR
+//       in host/CMakeLists.txt:
+//         git worktree add /tmp/baseline <commit>
+//         cmake -S host -B build -DBASELINE_DIR=/tmp/baseline
+//
+//       usage: LEDFrameCostBenchmark [seconds]   (default 10 virtual seconds per strip length)
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <chrono>
+
+#include "LEDClusterController.h"
+#include "LEDCluster.h"
+#ifndef HOST_BASELINE
+#include "LEDNeoPixelSink.h"
+#endif
+
+#define BENCHMARK_CLUSTERS  11
+#define BENCHMARK_WIDTH     20    // pixels per cluster
+#define BENCHMARK_INTERVAL  10    // milliseconds between calls of show()
+
+static void runStrip(const uint16_t numPixels, const uint32_t seconds) {
+  static const uint32_t colors[] = { COLOR_RED, COLOR_GREEN, COLOR_BLUE, COLOR_YELLOW, COLOR_CYAN, COLOR_MAGENTA, COLOR_WHITE };
+  HostArduino::setTime(0);
+#ifdef HOST_BASELINE
+  LEDClusterController *controller = new LEDClusterController(numPixels, DATA_PIN, WS2815CONFIG, BENCHMARK_CLUSTERS);
+#else
+  LEDNeoPixelSink *strip = new LEDNeoPixelSink(numPixels, DATA_PIN, WS2815CONFIG);
+  LEDClusterController *controller = new LEDClusterController(*strip, BENCHMARK_CLUSTERS, 4096);
+#endif
+  controller->begin();
+  for (uint8_t clusterNo=0; clusterNo<BENCHMARK_CLUSTERS; clusterNo++) {
+    LEDCluster *cluster = LEDCluster::initRGBPixel(colors[clusterNo % 7], BENCHMARK_WIDTH);
+    cluster->setDirection(LtR);
+    cluster->setUpdateInterval(40 + 10 * clusterNo);
+    cluster->enableWrapAround();
+    controller->addCluster(cluster, (uint32_t)numPixels * clusterNo / BENCHMARK_CLUSTERS);
+  }
+
+  uint32_t calls = 0;
+  uint32_t showCount = Adafruit_NeoPixel::getTotalShowCount();
+  std::chrono::steady_clock::duration showTime = std::chrono::steady_clock::duration::zero();
+  while (millis() < seconds * 1000) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    controller->show();
+    showTime += std::chrono::steady_clock::now() - start;
+    calls++;
+    delay(BENCHMARK_INTERVAL);
+  }
+  uint32_t frames = Adafruit_NeoPixel::getTotalShowCount() - showCount;
+  double ns = std::chrono::duration<double, std::nano>(showTime).count();
+  printf("%6u %7u %7u %12.0f %12.0f\n", numPixels, calls, frames, ns / calls, (frames > 0) ? ns / frames : 0.0);
+
+  delete controller;
+#ifndef HOST_BASELINE
+  delete strip;
+#endif
+}
+
+int main(int argc, char *argv[]) {
+  static const uint16_t stripLengths[] = { 60, 300, 1036, 4096 };
+  uint32_t seconds = (argc > 1) ? strtoul(argv[1], NULL, 0) : 10;
+  if (0 == seconds) return 1;
+
+  HostArduino::setSerialOutput(NULL);
+  printf("%6s %7s %7s %12s %12s\n", "pixels", "calls", "frames", "ns/call", "ns/frame");
+  for (uint8_t lengthNo=0; lengthNo<sizeof(stripLengths)/sizeof(stripLengths[0]); lengthNo++) {
+    runStrip(stripLengths[lengthNo], seconds);
+  }
+  return 0;
+}
@@ -0,0 +1,148 @@
+// NAME: LEDFrameFile.cpp
+//
+// DESC: Compact file of rendered frames of a virtual LED strip, see LEDHostRenderer.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <string.h>
+
+#include "LEDFrameFile.h"
+
+static const char FRAME_FILE_MAGIC[4] = { 'L', 'E', 'D', 'F' };
+
+LEDFrameFile::LEDFrameFile() {
+  file = NULL;
+  numPixels = 0;
+  frameInterval = 0;
+  numFrames = 0;
+  bytesWritten = 0;
+}
+
+LEDFrameFile::~LEDFrameFile() {
+  close();
+}
+
+bool LEDFrameFile::create(const char *path, const uint32_t numPixels, const uint32_t frameInterval) {
+  close();
+  file = fopen(path, "wb");
+  if (NULL == file) return false;
+
+  this->numPixels = numPixels;
+  this->frameInterval = frameInterval;
+  previous.assign(numPixels, 0L);
+  numFrames = 0;
+
+  uint8_t header[13];
+  memcpy(header, FRAME_FILE_MAGIC, 4);
+  header[4] = FRAME_FILE_VERSION;
+  for (uint8_t byteNo=0; byteNo<4; byteNo++) {
+    header[5 + byteNo] = (numPixels >> (8 * byteNo)) & 0xff;
+    header[9 + byteNo] = (frameInterval >> (8 * byteNo)) & 0xff;
+  }
+  bytesWritten = fwrite(header, 1, sizeof(header), file);
+  return bytesWritten == sizeof(header);
+}
+
+bool LEDFrameFile::open(const char *path) {
+  close();
+  file = fopen(path, "rb");
+  if (NULL == file) return false;
+
+  uint8_t header[13];
+  if ((fread(header, 1, sizeof(header), file) != sizeof(header)) ||
+      (0 != memcmp(header, FRAME_FILE_MAGIC, 4)) || (FRAME_FILE_VERSION != header[4])) {
+    close();
+    return false;
+  }
+  numPixels = header[5] | (header[6] << 8) | (header[7] << 16) | ((uint32_t)header[8] << 24);
+  frameInterval = header[9] | (header[10] << 8) | (header[11] << 16) | ((uint32_t)header[12] << 24);
+  numFrames = 0;
+  return true;
+}
+
+void LEDFrameFile::close() {
+  if (NULL != file) fclose(file);
+  file = NULL;
+}
+
+void LEDFrameFile::putVarint(uint32_t value) {
+  while (value >= 0x80) {
+    buffer.push_back((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  buffer.push_back(value);
+}
+
+bool LEDFrameFile::getVarint(uint32_t &value) {
+  value = 0;
+  for (uint8_t shift=0; shift<35; shift+=7) {
+    int data = fgetc(file);
+    if (EOF == data) return false;
+    value |= (uint32_t)(data & 0x7f) << shift;
+    if (0 == (data & 0x80)) return true;
+  }
+  return false;
+}
+
+bool LEDFrameFile::writeFrame(const uint32_t *pixels) {
+  if (NULL == file) return false;
+
+  // collect runs of changed pixels
+  std::vector<uint32_t> runs;   // pairs of skip and count
+  uint32_t pixelNo = 0;
+  uint32_t runEnd = 0;          // end of previous run
+  while (pixelNo < numPixels) {
+    if (pixels[pixelNo] == previous[pixelNo]) {
+      pixelNo++;
+      continue;
+    }
+    uint32_t runStart = pixelNo;
+    while ((pixelNo < numPixels) && (pixels[pixelNo] != previous[pixelNo])) pixelNo++;
+    runs.push_back(runStart - runEnd);
+    runs.push_back(pixelNo - runStart);
+    runEnd = pixelNo;
+  }
+
+  buffer.clear();
+  putVarint(runs.size() / 2);
+  uint32_t runStart = 0;
+  for (size_t run=0; run<runs.size(); run+=2) {
+    putVarint(runs[run]);
+    putVarint(runs[run+1]);
+    runStart += runs[run];
+    for (uint32_t no=runStart; no<runStart+runs[run+1]; no++) {
+      buffer.push_back((pixels[no] >> 16) & 0xff);
+      buffer.push_back((pixels[no] >> 8) & 0xff);
+      buffer.push_back(pixels[no] & 0xff);
+      previous[no] = pixels[no];
+    }
+    runStart += runs[run+1];
+  }
+
+  size_t written = fwrite(buffer.data(), 1, buffer.size(), file);
+  bytesWritten += written;
+  numFrames++;
+  return written == buffer.size();
+}
+
+bool LEDFrameFile::readFrame(uint32_t *pixels) {
+  if (NULL == file) return false;
+
+  uint32_t numRuns;
+  if (!getVarint(numRuns)) return false;
+  uint32_t pixelNo = 0;
+  for (uint32_t run=0; run<numRuns; run++) {
+    uint32_t skip, count;
+    if (!getVarint(skip) || !getVarint(count)) return false;
+    pixelNo += skip;
+    if (pixelNo + count > numPixels) return false;
+    for (uint32_t no=0; no<count; no++, pixelNo++) {
+      uint8_t rgb[3];
+      if (fread(rgb, 1, 3, file) != 3) return false;
+      pixels[pixelNo] = ((uint32_t)rgb[0] << 16) | ((uint32_t)rgb[1] << 8) | rgb[2];
+    }
+  }
+  numFrames++;
+  return true;
+}
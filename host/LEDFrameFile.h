@@ -0,0 +1,57 @@
+// NAME: LEDFrameFile.h
+//
+// DESC: Compact file of rendered frames of a virtual LED strip, see LEDHostRenderer.
+//
+//       Header: "LEDF", version(1), numPixels(4), frameInterval(4) in milliseconds.
+//       Every frame holds only the pixels changed since the previous frame:
+//         numRuns, then per run: skip, count, count R-G-B triples
+//       with all numbers as varints (7 bits per byte, least significant first, bit 7 set
+//       for continuation). An unchanged frame takes one byte.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDFRAMEFILE_H
+#define LEDFRAMEFILE_H
+
+#ifdef ARDUINO
+#error LEDFrameFile is for host builds only
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#define FRAME_FILE_VERSION  1
+
+class LEDFrameFile {
+private:
+  FILE      *file;
+  uint32_t  numPixels;
+  uint32_t  frameInterval;
+  std::vector<uint32_t> previous;   // pixels of previous frame
+  std::vector<uint8_t> buffer;      // encoded frame
+  uint32_t  numFrames;
+  uint64_t  bytesWritten;
+
+  void putVarint(uint32_t value);
+  bool getVarint(uint32_t &value);
+
+public:
+  LEDFrameFile();
+  ~LEDFrameFile();
+
+  bool create(const char *path, const uint32_t numPixels, const uint32_t frameInterval);
+  bool open(const char *path);  // for reading
+  void close();
+
+  bool writeFrame(const uint32_t *pixels);
+  bool readFrame(uint32_t *pixels);   // pixels must hold the previous frame
+
+  uint32_t getNumPixels() const     { return numPixels; }
+  uint32_t getFrameInterval() const { return frameInterval; }
+  uint32_t getNumFrames() const     { return numFrames; }
+  uint64_t getBytesWritten() const  { return bytesWritten; }
+};
+
+#endif /* LEDFRAMEFILE_H */
@@ -0,0 +1,222 @@
+// NAME: LEDHostRenderer.cpp
+//
+// DESC: Host only renderer for virtual LED strips far longer than LEDClusterController
+//       supports (up to millions of pixels), e.g. for previews of large installations.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <algorithm>
+
+#include "LEDHostRenderer.h"
+#include "../LEDBlendSink.h"
+#include "../LEDSpanKernels.h"
+
+LEDHostRenderer::LEDHostRenderer(const uint32_t numPixels, const uint32_t tileSize /* =HOST_TILE_SIZE */, uint32_t numThreads /* =0 */)
+                :pixels(numPixels, 0L) {
+  numLEDs = numPixels;
+  this->tileSize = (tileSize > 0) ? tileSize : HOST_TILE_SIZE;
+  numTiles = (numLEDs + this->tileSize - 1) / this->tileSize;
+  maxSpanLength = 0;
+  frameTime = 0L;
+
+  generation = 0;
+  busyWorkers = 0;
+  nextTile = 0;
+  stopping = false;
+  if (0 == numThreads) numThreads = std::thread::hardware_concurrency();
+  for (uint32_t threadNo=1; threadNo<numThreads; threadNo++) { // the calling thread composes, too
+    workers.push_back(std::thread(&LEDHostRenderer::work, this));
+  }
+}
+
+LEDHostRenderer::~LEDHostRenderer() {
+  {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    stopping = true;
+  }
+  workReady.notify_all();
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  for (LEDCluster *cluster : clusters) {
+    delete cluster;
+  }
+}
+
+void LEDHostRenderer::addCluster(LEDCluster *cluster, const int32_t position /* =0 */) {
+  if (NULL == cluster) return;
+  cluster->setStartPosition(position);
+  cluster->setPosition(position);
+  cluster->setLastUpdate(frameTime);
+  cluster->setLastMotion(frameTime);
+
+  // on top of its layer
+  std::vector<LEDCluster *>::iterator pos = clusters.end();
+  while ((pos != clusters.begin()) && ((*(pos-1))->getLayer() > cluster->getLayer())) {
+    pos--;
+  }
+  clusters.insert(pos, cluster);
+}
+
+/*
+ * animation, like LEDClusterController::show()
+ */
+void LEDHostRenderer::advance(const uint32_t time) {
+  frameTime = time;
+
+  for (LEDCluster *cluster : clusters) {
+    if (!cluster->isStarted(frameTime)) continue;
+
+    if (cluster->isSmooth()) {
+      cluster->glide(numLEDs, frameTime);
+      if (cluster->isDone() || !cluster->isStarted(frameTime)) continue;
+    }
+
+    uint32_t steps = cluster->getElapsedSteps(frameTime);
+    if (steps == 0L) continue;
+    if (steps > numLEDs) steps = numLEDs;
+
+    cluster->update(steps);
+
+    if (cluster->isSmooth()) continue;
+    for (uint32_t step=0; step<steps; step++) {
+      cluster->step(numLEDs, frameTime);
+      if (cluster->isDone() || !cluster->isStarted(frameTime)) break;
+    }
+  }
+
+  removeDone();
+}
+
+void LEDHostRenderer::removeDone() {
+  std::vector<LEDCluster *>::iterator keep = clusters.begin();
+  for (LEDCluster *cluster : clusters) {
+    if (cluster->isDone()) {
+      delete cluster;
+    }
+    else *keep++ = cluster;
+  }
+  clusters.erase(keep, clusters.end());
+}
+
+/*
+ * composition
+ */
+void LEDHostRenderer::indexSpans() {
+  spans.clear();
+  maxSpanLength = 0;
+  for (uint32_t zRank=0; zRank<clusters.size(); zRank++) {
+    LEDCluster *cluster = clusters[zRank];
+    int32_t start = cluster->getSpanStart();
+    int32_t end = cluster->getSpanEnd();
+    if (!cluster->isStarted(frameTime) || (end <= 0L) || (start >= (int32_t)numLEDs)) continue;
+
+    LEDHostSpan span = { cluster, std::max(start, (int32_t)0), std::min(end, (int32_t)numLEDs), zRank };
+    spans.push_back(span);
+    if (end - start > maxSpanLength) maxSpanLength = end - start;
+  }
+  std::sort(spans.begin(), spans.end(), [](const LEDHostSpan &a, const LEDHostSpan &b) { return a.start < b.start; });
+}
+
+void LEDHostRenderer::compose() {
+  indexSpans();
+
+  nextTile = 0;
+  {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    busyWorkers = workers.size();
+    generation++;
+  }
+  workReady.notify_all();
+
+  std::vector<const LEDHostSpan *> covering;
+  composeTiles(covering);
+
+  std::unique_lock<std::mutex> lock(poolMutex);
+  workDone.wait(lock, [this] { return 0 == busyWorkers; });
+}
+
+void LEDHostRenderer::work() {
+  std::vector<const LEDHostSpan *> covering;
+  uint32_t done = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(poolMutex);
+      workReady.wait(lock, [this, done] { return stopping || (generation != done); });
+      if (stopping) return;
+      done = generation;
+    }
+
+    composeTiles(covering);
+
+    {
+      std::lock_guard<std::mutex> lock(poolMutex);
+      busyWorkers--;
+    }
+    workDone.notify_one();
+  }
+}
+
+void LEDHostRenderer::composeTiles(std::vector<const LEDHostSpan *> &covering) {
+  uint32_t tileNo;
+  while ((tileNo = nextTile++) < numTiles) {
+    composeTile(tileNo, covering);
+  }
+}
+
+/*
+ * compose one tile like LEDClusterController::composeRange()
+ */
+void LEDHostRenderer::composeTile(const uint32_t tileNo, std::vector<const LEDHostSpan *> &covering) {
+  int32_t tileStart = tileNo * tileSize;
+  int32_t tileEnd = std::min(tileStart + (int32_t)tileSize, (int32_t)numLEDs);
+  uint32_t *tile = pixels.data();
+  std::fill(tile + tileStart, tile + tileEnd, 0L);
+
+  // clusters covering the tile in z-order
+  covering.clear();
+  int32_t lowestStart = tileStart - maxSpanLength;
+  std::vector<LEDHostSpan>::const_iterator span = std::lower_bound(spans.begin(), spans.end(), lowestStart,
+    [](const LEDHostSpan &a, const int32_t start) { return a.start < start; });
+  for (; (span != spans.end()) && (span->start < tileEnd); span++) {
+    if (span->end > tileStart) covering.push_back(&*span);
+  }
+  std::sort(covering.begin(), covering.end(), [](const LEDHostSpan *a, const LEDHostSpan *b) { return a->zRank < b->zRank; });
+
+  for (const LEDHostSpan *cover : covering) {
+    const LEDCluster *cluster = cover->cluster;
+    int32_t firstPixel = std::max(cover->start, tileStart);
+    int32_t endPixel = std::min(cover->end, tileEnd);
+
+    uint8_t coverage = cluster->getCoverage();
+    int32_t pixelsEnd = cluster->getPixelsEnd();
+    bool smoothFirst = (coverage > 0) && (cluster->getSpanStart() == firstPixel) && (pixelsEnd > firstPixel);
+    bool smoothLast = (coverage > 0) && (pixelsEnd >= firstPixel) && (pixelsEnd < endPixel);
+    uint32_t belowFirst = smoothFirst ? tile[firstPixel] : 0L;
+    uint32_t belowLast = smoothLast ? tile[pixelsEnd] : 0L;
+    int32_t renderEnd = smoothLast ? pixelsEnd : endPixel;
+
+    BlendMode mode = cluster->getBlendMode();
+    int32_t position = cluster->getPosition();
+    uint16_t length = cluster->getLength();
+    if (cluster->isUniform()) {
+      if (renderEnd > firstPixel) spanBlend32(tile + firstPixel, mode, cluster->getColor(0), renderEnd - firstPixel);
+    }
+    else {
+      uint16_t index = (firstPixel - position) % length;
+      for (int32_t pixelNo=firstPixel; pixelNo<renderEnd; pixelNo++) {
+        tile[pixelNo] = LEDBlendSink::blend(mode, tile[pixelNo], cluster->getColor(index));
+        if (++index == length) index = 0; // next replica
+      }
+    }
+
+    if (smoothFirst) {
+      tile[firstPixel] = LEDBlendSink::mix(belowFirst, tile[firstPixel], 255 - coverage);
+    }
+    if (smoothLast) {
+      uint32_t color = LEDBlendSink::blend(mode, belowLast, cluster->getColor(length-1));
+      tile[pixelsEnd] = LEDBlendSink::mix(belowLast, color, coverage);
+    }
+  }
+}
@@ -0,0 +1,98 @@
+// NAME: LEDHostRenderer.h
+//
+// DESC: Host only renderer for virtual LED strips far longer than LEDClusterController
+//       supports (up to millions of pixels), e.g. for previews of large installations.
+//
+//       The LEDClusters are updated and moved by the same rules as by LEDClusterController
+//       (see LEDCluster::step() and LEDCluster::glide()), but the virtual LED strip is split
+//       into tiles, which a pool of threads composes in parallel. As every frame is composed
+//       completely, no damage tracking is needed.
+//
+//       The speedup with the number of cores is still to be measured: so far it only ran
+//       on a single core, where more threads add just the overhead of the pool.
+//
+//       Limits: clusters are updated sequentially, and smooth movement (see
+//       LEDCluster::setVelocity()) is limited to the first 32767 pixels by the 16.16
+//       fixed-point position of LEDCluster.
+//
+//       Compiled for the host by host/CMakeLists.txt (library ledhost, program LEDPreview)
+//       together with the LEDCluster sources of the sketch directory and the Arduino
+//       compatibility layer in host/stubs. The Arduino IDE does not compile this directory.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDHOSTRENDERER_H
+#define LEDHOSTRENDERER_H
+
+#ifdef ARDUINO
+#error LEDHostRenderer is for host builds only
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../LEDCluster.h"
+
+#define HOST_TILE_SIZE  4096  // default number of pixels per tile
+
+/*
+ * visible span of a cluster in the current frame
+ */
+struct LEDHostSpan {
+  LEDCluster  *cluster;
+  int32_t     start;        // first visible pixel
+  int32_t     end;          // first pixel behind visible span
+  uint32_t    zRank;        // position in z-order
+};
+
+class LEDHostRenderer {
+private:
+  uint32_t  numLEDs;
+  uint32_t  tileSize;
+  uint32_t  numTiles;
+  std::vector<uint32_t> pixels;         // R-G-B of the virtual LED strip
+  std::vector<LEDCluster *> clusters;   // in z-order, see addCluster()
+  std::vector<LEDHostSpan> spans;       // visible spans sorted by start, see indexSpans()
+  int32_t   maxSpanLength;
+  uint32_t  frameTime;                  // virtual time in milliseconds
+
+  /*
+   * thread pool composing tiles
+   */
+  std::vector<std::thread> workers;
+  std::mutex              poolMutex;
+  std::condition_variable workReady;
+  std::condition_variable workDone;
+  uint32_t                generation;   // incremented for every frame to compose
+  uint32_t                busyWorkers;
+  std::atomic<uint32_t>   nextTile;
+  bool                    stopping;
+
+  void removeDone();
+  void indexSpans();
+
+  void work();
+  void composeTiles(std::vector<const LEDHostSpan *> &covering);
+  void composeTile(const uint32_t tileNo, std::vector<const LEDHostSpan *> &covering);
+
+public:
+  LEDHostRenderer(const uint32_t numPixels, const uint32_t tileSize = HOST_TILE_SIZE, uint32_t numThreads = 0); // 0: all cores
+  ~LEDHostRenderer();
+
+  void addCluster(LEDCluster *cluster, const int32_t position = 0); // on top of its layer, deleted by the renderer
+
+  void advance(const uint32_t time);  // update and move clusters up to virtual time in milliseconds
+  void compose();                     // compose all clusters into the pixels
+
+  uint32_t numPixels() const      { return numLEDs; }
+  const uint32_t *getPixels() const { return pixels.data(); }
+  uint32_t getPixelColor(const uint32_t pixelNo) const { return (pixelNo < numLEDs) ? pixels[pixelNo] : 0L; }
+  uint32_t getNumClusters() const { return clusters.size(); }
+  uint32_t getNumThreads() const  { return workers.size() + 1; }
+};
+
+#endif /* LEDHOSTRENDERER_H */
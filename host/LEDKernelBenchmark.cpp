@@ -0,0 +1,98 @@
+// NAME: LEDKernelBenchmark.cpp
+//
+// DESC: Host benchmark of the stages of the composition of a frame, see LEDSpanKernels.h:
+//       every kernel on spans of numPixels pixels, the span paths of LEDBlendSink and
+//       LEDNeoPixelSink against their per pixel paths, and show() of LEDDoubleBufferSink
+//       with and without dithered brightness. Reports pixels per ns and ns per frame.
+//
+//       host/CMakeLists.txt builds the kernels for this host (LEDKernelBenchmark) and on x86
+//       also for SSE2 only, 32 bit SWAR and the scalar loops of AVR (LEDKernelBenchmarkSSE2,
+//       ...SWAR, ...Scalar), so the paths can be compared on one machine.
+//
+//       usage: LEDKernelBenchmark [numPixels]   (default 1036)
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <chrono>
+#include <vector>
+
+#include "LEDBlendSink.h"
+#include "LEDDoubleBufferSink.h"
+#include "LEDFrameBufferSink.h"
+#include "LEDNeoPixelSink.h"
+#include "LEDSpanKernels.h"
+
+static uint16_t numPixels;
+
+/*
+ * pixels per ns of stage, repeated for at least 0.1 s
+ */
+template<class Stage> static double measure(Stage stage) {
+  for (uint16_t i=0; i<100; i++) stage();
+  uint32_t reps = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::duration elapsed;
+  do {
+    for (uint16_t i=0; i<100; i++) {
+      stage();
+      asm volatile("" ::: "memory");  // keep every repetition
+    }
+    reps += 100;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(100));
+  return (double)numPixels * reps / std::chrono::duration<double, std::nano>(elapsed).count();
+}
+
+static void report(const char *stage, const double pixelsPerNs) {
+  printf("%-24s %8.2f %10.0f\n", stage, pixelsPerNs, numPixels / pixelsPerNs);
+}
+
+int main(int argc, char *argv[]) {
+  numPixels = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1036;
+  if (0 == numPixels) return 1;
+
+  std::vector<uint8_t> pixels(numPixels * 3);
+  std::vector<uint8_t> wire(numPixels * 3);
+  std::vector<uint32_t> pixels32(numPixels);
+  for (uint32_t i=0; i<pixels.size(); i++) pixels[i] = i * 7;
+  uint32_t sums[3] = { 0L, 0L, 0L };
+
+  printf("%-24s %8s %10s\n", "stage", "px/ns", "ns/frame");
+  report("spanFill", measure([&]{ spanFill(pixels.data(), 0x102030, numPixels); }));
+  report("spanBlend add", measure([&]{ spanBlend(pixels.data(), BlendAdd, 0x010203, numPixels); }));
+  report("spanBlend max", measure([&]{ spanBlend(pixels.data(), BlendMax, 0x405060, numPixels); }));
+  report("spanScale", measure([&]{ spanScale(pixels.data(), 200, numPixels); }));
+  report("spanSwizzle GRB", measure([&]{ spanSwizzle(wire.data(), pixels.data(), 1, 0, 2, numPixels); }));
+  report("spanIntensity", measure([&]{ spanIntensity(pixels.data(), numPixels, sums); }));
+  report("spanBlend32 max", measure([&]{ spanBlend32(pixels32.data(), BlendMax, 0x405060, numPixels); }));
+
+  // blended fill: LEDBlendSink per pixel against its span path
+  LEDFrameBufferSink frameBuffer(numPixels);
+  LEDBlendSink blendSink(frameBuffer, BlendAdd);
+  report("blend add per pixel", measure([&]{ for (uint16_t pixelNo=0; pixelNo<numPixels; pixelNo++) blendSink.setPixelColor(pixelNo, 0x010203); }));
+  report("blend add span", measure([&]{ blendSink.fill(0x010203, 0, numPixels); }));
+
+  // copy of a frame into the wire buffer of Adafruit_NeoPixel, dimmed and in GRB order
+  LEDNeoPixelSink neoPixel(numPixels, DATA_PIN, NEO_GRB + NEO_KHZ800);
+  neoPixel.setBrightness(100);
+  const uint8_t *rgb = pixels.data();
+  report("NeoPixel per pixel", measure([&]{
+    for (uint16_t pixelNo=0; pixelNo<numPixels; pixelNo++) {
+      const uint8_t *pixel = rgb + pixelNo * 3;
+      neoPixel.setPixelColor(pixelNo, ((uint32_t)pixel[0] << 16) | ((uint32_t)pixel[1] << 8) | pixel[2]);
+    }
+  }));
+  report("NeoPixel writePixels", measure([&]{ neoPixel.writePixels(0, rgb, numPixels); }));
+
+  // show() of a back buffer with a third of the pixels lit, plain and with dithered brightness
+  LEDDoubleBufferSink doubleBuffer(neoPixel);
+  for (uint16_t pixelNo=0; pixelNo<numPixels; pixelNo++) {
+    const uint8_t *pixel = rgb + pixelNo * 3;
+    doubleBuffer.setPixelColor(pixelNo, (0 == pixelNo % 3) ? ((uint32_t)pixel[0] << 16) | ((uint32_t)pixel[1] << 8) | pixel[2] : 0L);
+  }
+  report("double buffer show", measure([&]{ doubleBuffer.setPixelColor(0, 0x102030); doubleBuffer.show(); }));
+  doubleBuffer.setDithering(true);
+  report("dithered show", measure([&]{ doubleBuffer.setPixelColor(0, 0x102030); doubleBuffer.show(); }));
+  return 0;
+}
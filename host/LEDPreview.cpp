@@ -0,0 +1,97 @@
+// NAME: LEDPreview.cpp
+//
+// DESC: Host program rendering a simulated installation with LEDHostRenderer offline,
+//       optionally into an LEDFrameFile, and reporting the rendering speed.
+//
+//       usage: LEDPreview numPixels numClusters seconds [fps [threads [tileSize [frameFile]]]]
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "LEDHostRenderer.h"
+#include "LEDFrameFile.h"
+
+/*
+ * random installation of moving clusters of all kinds
+ */
+static void addClusters(LEDHostRenderer &renderer, const uint32_t numClusters) {
+  srand(1);
+  for (uint32_t clusterNo=0; clusterNo<numClusters; clusterNo++) {
+    LEDCluster *cluster = NULL;
+    switch (clusterNo % 5) {
+      case 0:
+        cluster = LEDCluster::initRGBPixel(rand() & 0xffffff, 1 + rand() % 20);
+        break;
+      case 1:
+        cluster = LEDCluster::initRGBRainbow(6 + rand() % 60);
+        break;
+      case 2:
+        cluster = LEDCluster::initRGBPattern(rand() & 0xffffff, rand() & 0xff);
+        break;
+      case 3:
+        cluster = LEDCluster::initPulsarPixel(rand() & 0xffff, 1 + rand() % 8, 1 + rand() % 10);
+        break;
+      case 4:
+        cluster = LEDCluster::initPixelSource(11 + rand() % 40, rand() & 0xffff);
+        break;
+    }
+    if (NULL == cluster) continue;
+
+    cluster->setDirection((rand() & 1) ? LtR : RtL);
+    cluster->setUpdateInterval(5 + rand() % 200);
+    cluster->enableWrapAround();
+    cluster->setLayer(rand() % 4);
+    cluster->setBlendMode((BlendMode)(rand() % 3));
+    renderer.addCluster(cluster, rand() % renderer.numPixels());
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 4) {
+    fprintf(stderr, "usage: %s numPixels numClusters seconds [fps [threads [tileSize [frameFile]]]]\n", argv[0]);
+    return 1;
+  }
+  uint32_t numPixels = strtoul(argv[1], NULL, 0);
+  uint32_t numClusters = strtoul(argv[2], NULL, 0);
+  uint32_t seconds = strtoul(argv[3], NULL, 0);
+  uint32_t fps = (argc > 4) ? strtoul(argv[4], NULL, 0) : 50;
+  uint32_t numThreads = (argc > 5) ? strtoul(argv[5], NULL, 0) : 0;
+  uint32_t tileSize = (argc > 6) ? strtoul(argv[6], NULL, 0) : HOST_TILE_SIZE;
+  const char *path = (argc > 7) ? argv[7] : NULL;
+  if ((0 == numPixels) || (0 == fps)) return 1;
+
+  LEDHostRenderer renderer(numPixels, tileSize, numThreads);
+  addClusters(renderer, numClusters);
+
+  LEDFrameFile frameFile;
+  if ((NULL != path) && !frameFile.create(path, numPixels, 1000 / fps)) {
+    fprintf(stderr, "cannot create %s\n", path);
+    return 1;
+  }
+
+  uint32_t numFrames = seconds * fps;
+  double composeSeconds = 0.0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint32_t frameNo=0; frameNo<numFrames; frameNo++) {
+    renderer.advance((uint64_t)frameNo * 1000 / fps);
+
+    std::chrono::steady_clock::time_point composeStart = std::chrono::steady_clock::now();
+    renderer.compose();
+    composeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - composeStart).count();
+
+    if (NULL != path) frameFile.writeFrame(renderer.getPixels());
+  }
+  double totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  printf("pixels=%u clusters=%u threads=%u tile=%u frames=%u\n", numPixels, renderer.getNumClusters(), renderer.getNumThreads(), tileSize, numFrames);
+  printf("compose %.3f ms/frame, %.1f Mpixels/s; total %.3f s, %.1fx real time\n",
+    composeSeconds * 1000.0 / numFrames, (double)numPixels * numFrames / composeSeconds / 1e6, totalSeconds, seconds / totalSeconds);
+  if (NULL != path) {
+    printf("frame file %llu bytes, %.1f bytes/frame\n", (unsigned long long)frameFile.getBytesWritten(), (double)frameFile.getBytesWritten() / numFrames);
+  }
+  return 0;
+}
@@ -0,0 +1,47 @@
+// NAME: LEDSketch.cpp
+//
+// DESC: Host program running LEDStripTest.ino with the configuration of LEDStripTest.h for
+//       some virtual seconds, e.g. the ABSCHNITT segments of the installation, and reporting
+//       the time loop() takes, the frames transmitted and the heap in use.
+//
+//       usage: LEDSketch [seconds]   (default 60, at most 600: the sketch stops after 10min)
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <chrono>
+
+#include "../LEDStripTest.ino"
+
+/*
+ * transmissions to the LED strip, of all channels
+ */
+static uint32_t getShowCount() {
+#ifdef USE_DOTSTAR
+  return Adafruit_DotStar::getTotalShowCount();
+#else
+  return Adafruit_NeoPixel::getTotalShowCount();
+#endif
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t seconds = (argc > 1) ? strtoul(argv[1], NULL, 0) : 60;
+  if (seconds > 600) seconds = 600;
+
+  setup();
+  size_t heapInUse = HostArduino::getHeapInUse();
+
+  uint32_t loops = 0;
+  uint32_t showCount = getShowCount();
+  uint32_t stopTime = millis() + seconds * 1000;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  while ((int32_t)(millis() - stopTime) < 0) {
+    loop();
+    loops++;
+  }
+  double loopSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  printf("pixels=%u clusters=%u seconds=%u loops=%u frames=%u\n", ledController.numPixels(), ledController.getNumClusters(), seconds, loops, getShowCount() - showCount);
+  printf("loop %.0f ns, %.1f loops/s virtual; heap in use %u bytes\n", loopSeconds * 1e9 / loops, (double)loops / seconds, (unsigned)heapInUse);
+  return 0;
+}
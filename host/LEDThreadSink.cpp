@@ -0,0 +1,86 @@
+// NAME: LEDThreadSink.cpp
+//
+// DESC: Host only LEDPixelSink transmitting in the background, see LEDThreadSink.h.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <chrono>
+#include <string.h>
+
+#include "LEDThreadSink.h"
+
+LEDThreadSink::LEDThreadSink(const uint16_t numLEDs, const uint32_t nanosPerPixel /* =30000 */)
+              :LEDFrameBufferSink(numLEDs), transmitted(3L * numLEDs) {
+  this->nanosPerPixel = nanosPerPixel;
+  busy = false;
+  framesTransmitted = 0;
+  tornFrames = 0;
+  writesWhileBusy = 0;
+  pending = false;
+  stopping = false;
+  worker = std::thread(&LEDThreadSink::transmit, this);
+}
+
+LEDThreadSink::~LEDThreadSink() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  frameReady.notify_one();
+  worker.join();
+}
+
+void LEDThreadSink::show() {
+  waitIdle();
+  LEDFrameBufferSink::show(); // counts the frame
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    busy = true;
+    pending = true;
+  }
+  frameReady.notify_one();
+}
+
+void LEDThreadSink::transmit() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    frameReady.wait(lock, [this] { return pending || stopping; });
+    if (stopping) return;
+    pending = false;
+    lock.unlock();
+
+    // clock out the frame slice by slice in the time on the wire
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint32_t numBytes = 3L * numPixels();
+    for (uint8_t sliceNo=0; sliceNo<THREAD_SINK_SLICES; sliceNo++) {
+      uint32_t first = numBytes * sliceNo / THREAD_SINK_SLICES;
+      uint32_t end = numBytes * (sliceNo + 1) / THREAD_SINK_SLICES;
+      memcpy(&transmitted[first], getPixels() + first, end - first);
+      std::this_thread::sleep_until(start + std::chrono::nanoseconds((uint64_t)numPixels() * nanosPerPixel * (sliceNo + 1) / THREAD_SINK_SLICES));
+    }
+    if (0 != memcmp(transmitted.data(), getPixels(), numBytes)) tornFrames++;
+    framesTransmitted++;
+
+    lock.lock();
+    busy = false;
+  }
+}
+
+void LEDThreadSink::setPixelColor(const uint16_t pixelNo, const uint32_t color) {
+  checkWrite();
+  LEDFrameBufferSink::setPixelColor(pixelNo, color);
+}
+
+bool LEDThreadSink::blendFill(const BlendMode mode, const uint32_t color, const uint16_t firstPixel, const uint16_t count) {
+  checkWrite();
+  return LEDFrameBufferSink::blendFill(mode, color, firstPixel, count);
+}
+
+uint32_t LEDThreadSink::getTransmittedColor(const uint16_t pixelNo) const {
+  if (pixelNo < numPixels()) {
+    const uint8_t *pixel = &transmitted[pixelNo * 3];
+    return ((uint32_t)pixel[0] << 16) | ((uint32_t)pixel[1] << 8) | pixel[2];
+  }
+  else return 0L;
+}
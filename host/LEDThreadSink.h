@@ -0,0 +1,70 @@
+// NAME: LEDThreadSink.h
+//
+// DESC: Host only LEDPixelSink transmitting in the background: show() hands the frame to a
+//       worker thread, which clocks it out in real time like DMA to a WS2815 or APA102 strip
+//       would, and isBusy() is true until the last pixel left. The pixels are kept in memory
+//       like by LEDFrameBufferSink.
+//
+//       The shipped sinks (Adafruit_NeoPixel, Adafruit_DotStar) block in show(), so this sink
+//       is the only one, on which LEDDoubleBufferSink renders the next frame while the previous
+//       one is transmitted, and on which the channels of LEDMultiChannelSink overlap. It
+//       counts writes into the pixels while a frame is transmitted, which a fence missing in
+//       front of it would cause.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDTHREADSINK_H
+#define LEDTHREADSINK_H
+
+#ifdef ARDUINO
+#error LEDThreadSink is for host builds only
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../LEDFrameBufferSink.h"
+
+#define THREAD_SINK_SLICES  16  // parts of a frame clocked out one after another
+
+class LEDThreadSink : public LEDFrameBufferSink {
+private:
+  uint32_t                nanosPerPixel;      // time on the wire per pixel
+  std::vector<uint8_t>    transmitted;        // R-G-B triples as clocked out by the worker
+  std::atomic<bool>       busy;
+  std::atomic<uint32_t>   framesTransmitted;
+  std::atomic<uint32_t>   tornFrames;         // frames, whose pixels changed while they were clocked out
+  uint32_t                writesWhileBusy;
+
+  std::thread             worker;
+  std::mutex              mutex;
+  std::condition_variable frameReady;
+  bool                    pending;            // show() handed a frame to the worker
+  bool                    stopping;
+
+  void transmit();
+  void checkWrite() { if (busy) writesWhileBusy++; }
+
+public:
+  LEDThreadSink(const uint16_t numLEDs, const uint32_t nanosPerPixel = 30000L); // WS2815 at 800 kHz
+  virtual ~LEDThreadSink();
+
+  virtual void show();                // waits for the previous frame, starts the next one, returns
+  virtual bool canShow()  { return !busy; }
+  virtual bool isBusy()   { return busy; }
+  virtual uint32_t getWireMicros() const { return ((uint64_t)numPixels() * nanosPerPixel) / 1000L; }
+
+  virtual void setPixelColor(const uint16_t pixelNo, const uint32_t color);
+  virtual bool blendFill(const BlendMode mode, const uint32_t color, const uint16_t firstPixel, const uint16_t count);
+
+  uint32_t getTransmittedColor(const uint16_t pixelNo) const; // pixel of the last frame clocked out, call when idle
+  uint32_t getFramesTransmitted() const { return framesTransmitted; }
+  uint32_t getTornFrames() const        { return tornFrames; }
+  uint32_t getWritesWhileBusy() const   { return writesWhileBusy; }
+};
+
+#endif /* LEDTHREADSINK_H */
@@ -0,0 +1,76 @@
+// NAME: Adafruit_DotStar.h
+//
+// DESC: Host version of the Adafruit_DotStar library with the same pixel buffer semantics,
+//       which differ from Adafruit_NeoPixel: setPixelColor() stores the colors unscaled in the
+//       color order of the strip, setBrightness() only stores the brightness, getPixelColor()
+//       returns the stored colors and show() applies the brightness while transmitting.
+//
+//       Instead of driving the SPI pins, show() captures the transmitted bytes with the
+//       brightness applied, see getShownPixels() and getShownColor(). Transmission takes no
+//       virtual time.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef ADAFRUIT_DOTSTAR_H
+#define ADAFRUIT_DOTSTAR_H
+
+#include <Arduino.h>
+
+// offsets of red, green and blue in a pixel like the Adafruit library
+#define DOTSTAR_RGB  (0 | (1 << 2) | (2 << 4))
+#define DOTSTAR_RBG  (0 | (2 << 2) | (1 << 4))
+#define DOTSTAR_GRB  (1 | (0 << 2) | (2 << 4))
+#define DOTSTAR_GBR  (2 | (0 << 2) | (1 << 4))
+#define DOTSTAR_BRG  (1 | (2 << 2) | (0 << 4))
+#define DOTSTAR_BGR  (2 | (1 << 2) | (0 << 4))
+
+extern const uint8_t _DotStarGammaTable[256];
+
+class Adafruit_DotStar {
+private:
+  uint16_t  numLEDs;
+  uint8_t   brightness;       // brightness + 1, 0 is full brightness
+  uint8_t   *pixels;
+  uint8_t   *shownPixels;     // pixels with brightness applied at the last show()
+  uint8_t   rOffset;
+  uint8_t   gOffset;
+  uint8_t   bOffset;
+  uint32_t  showCount;
+
+  static uint32_t totalShowCount;
+
+public:
+  Adafruit_DotStar(const uint16_t n, const uint8_t o = DOTSTAR_BRG);  // hardware SPI
+  Adafruit_DotStar(const uint16_t n, const uint8_t d, const uint8_t c, const uint8_t o = DOTSTAR_BRG);
+  ~Adafruit_DotStar();
+
+  void begin() {}
+  void show();
+
+  void setPixelColor(const uint16_t n, const uint32_t c);
+  void setPixelColor(const uint16_t n, const uint8_t r, const uint8_t g, const uint8_t b);
+  void fill(const uint32_t c = 0, uint16_t first = 0, uint16_t count = 0);
+  void setBrightness(const uint8_t b) { brightness = b + 1; }
+  void clear() { memset(pixels, 0, numLEDs * 3); }
+
+  uint8_t *getPixels() const { return pixels; }
+  uint8_t getBrightness() const { return brightness - 1; }
+  uint16_t numPixels() const { return numLEDs; }
+  uint32_t getPixelColor(const uint16_t n) const;
+
+  static uint8_t gamma8(const uint8_t x) { return pgm_read_byte(&_DotStarGammaTable[x]); }
+  static uint32_t gamma32(const uint32_t x);
+  static uint32_t Color(const uint8_t r, const uint8_t g, const uint8_t b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+  static uint32_t ColorHSV(uint16_t hue, const uint8_t sat = 255, const uint8_t val = 255);
+
+  // host only: capture of show()
+  uint32_t getShowCount() const { return showCount; }
+  static uint32_t getTotalShowCount() { return totalShowCount; }    // of all instances
+  const uint8_t *getShownPixels() const { return shownPixels; }
+  uint32_t getShownColor(const uint16_t n) const;   // color of pixel n as transmitted, 0xRRGGBB
+};
+
+#endif /* ADAFRUIT_DOTSTAR_H */
@@ -0,0 +1,177 @@
+// NAME: Adafruit_NeoPixel.cpp
+//
+// DESC: Host version of the Adafruit_NeoPixel library.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <Adafruit_NeoPixel.h>
+
+// gamma 2.6 like the table of the Adafruit library
+const uint8_t _NeoPixelGammaTable[256] PROGMEM = {
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   1,
+    1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,
+    3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   5,   6,   6,   6,   6,   7,
+    7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  10,  11,  11,  11,  12,  12,
+   13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,  20,
+   20,  21,  21,  22,  22,  23,  24,  24,  25,  25,  26,  27,  27,  28,  29,  29,
+   30,  31,  31,  32,  33,  34,  34,  35,  36,  37,  38,  38,  39,  40,  41,  42,
+   42,  43,  44,  45,  46,  47,  48,  49,  50,  51,  52,  53,  54,  55,  56,  57,
+   58,  59,  60,  61,  62,  63,  64,  65,  66,  68,  69,  70,  71,  72,  73,  75,
+   76,  77,  78,  80,  81,  82,  84,  85,  86,  88,  89,  90,  92,  93,  94,  96,
+   97,  99, 100, 102, 103, 105, 106, 108, 109, 111, 112, 114, 115, 117, 119, 120,
+  122, 124, 125, 127, 129, 130, 132, 134, 136, 137, 139, 141, 143, 145, 146, 148,
+  150, 152, 154, 156, 158, 160, 162, 164, 166, 168, 170, 172, 174, 176, 178, 180,
+  182, 184, 186, 188, 191, 193, 195, 197, 199, 202, 204, 206, 209, 211, 213, 215,
+  218, 220, 223, 225, 227, 230, 232, 235, 237, 240, 242, 245, 247, 250, 252, 255
+};
+
+uint32_t Adafruit_NeoPixel::totalShowCount = 0;
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(const uint16_t n, const int16_t pin, const neoPixelType type) {
+  (void)pin;
+  numLEDs = n;
+  brightness = 0;
+  pixels = NULL;
+  shownPixels = NULL;
+  showCount = 0;
+  updateType(type);
+}
+
+Adafruit_NeoPixel::~Adafruit_NeoPixel() {
+  free(pixels);
+  free(shownPixels);
+}
+
+void Adafruit_NeoPixel::updateType(const neoPixelType type) {
+  wOffset = (type >> 6) & 0b11;
+  rOffset = (type >> 4) & 0b11;
+  gOffset = (type >> 2) & 0b11;
+  bOffset = type & 0b11;
+  numBytes = numLEDs * ((wOffset == rOffset) ? 3 : 4);
+  free(pixels);
+  free(shownPixels);
+  pixels = (uint8_t *)calloc(numBytes, 1);
+  shownPixels = (uint8_t *)calloc(numBytes, 1);
+}
+
+void Adafruit_NeoPixel::show() {
+  memcpy(shownPixels, pixels, numBytes);
+  showCount++;
+  totalShowCount++;
+}
+
+void Adafruit_NeoPixel::setPixelColor(const uint16_t n, const uint32_t c) {
+  if (n >= numLEDs) return;
+  uint8_t r = (uint8_t)(c >> 16);
+  uint8_t g = (uint8_t)(c >> 8);
+  uint8_t b = (uint8_t)c;
+  uint8_t w = (uint8_t)(c >> 24);
+  if (brightness) {
+    r = (r * brightness) >> 8;
+    g = (g * brightness) >> 8;
+    b = (b * brightness) >> 8;
+    w = (w * brightness) >> 8;
+  }
+  uint8_t *p;
+  if (wOffset == rOffset) {
+    p = &pixels[n * 3];
+  }
+  else {
+    p = &pixels[n * 4];
+    p[wOffset] = w;
+  }
+  p[rOffset] = r;
+  p[gOffset] = g;
+  p[bOffset] = b;
+}
+
+void Adafruit_NeoPixel::setPixelColor(const uint16_t n, const uint8_t r, const uint8_t g, const uint8_t b) {
+  setPixelColor(n, Color(r, g, b));
+}
+
+void Adafruit_NeoPixel::fill(const uint32_t c, uint16_t first, uint16_t count) {
+  if (first >= numLEDs) return;
+  uint16_t end = ((0 == count) || ((uint32_t)first + count > numLEDs)) ? numLEDs : first + count;
+  for (uint16_t i=first; i<end; i++) {
+    setPixelColor(i, c);
+  }
+}
+
+/*
+ * rescale the pixel buffer from the old to the new brightness, lossy like the Adafruit library
+ */
+void Adafruit_NeoPixel::setBrightness(const uint8_t b) {
+  uint8_t newBrightness = b + 1;
+  if (newBrightness == brightness) return;
+  uint8_t oldBrightness = brightness - 1;
+  uint16_t scale;
+  if (0 == oldBrightness) scale = 0;
+  else if (255 == b) scale = 65535 / oldBrightness;
+  else scale = (((uint16_t)newBrightness << 8) - 1) / oldBrightness;
+  for (uint16_t i=0; i<numBytes; i++) {
+    pixels[i] = (pixels[i] * scale) >> 8;
+  }
+  brightness = newBrightness;
+}
+
+uint32_t Adafruit_NeoPixel::getPixelColor(const uint16_t n) const {
+  if (n >= numLEDs) return 0;
+  const uint8_t *p = (wOffset == rOffset) ? &pixels[n * 3] : &pixels[n * 4];
+  uint32_t w = (wOffset == rOffset) ? 0 : p[wOffset];
+  uint32_t r = p[rOffset];
+  uint32_t g = p[gOffset];
+  uint32_t b = p[bOffset];
+  if (brightness) {
+    w = (w << 8) / brightness;
+    r = (r << 8) / brightness;
+    g = (g << 8) / brightness;
+    b = (b << 8) / brightness;
+  }
+  return (w << 24) | (r << 16) | (g << 8) | b;
+}
+
+uint32_t Adafruit_NeoPixel::getShownColor(const uint16_t n) const {
+  if (n >= numLEDs) return 0;
+  const uint8_t *p = (wOffset == rOffset) ? &shownPixels[n * 3] : &shownPixels[n * 4];
+  return ((uint32_t)p[rOffset] << 16) | ((uint32_t)p[gOffset] << 8) | p[bOffset];
+}
+
+uint32_t Adafruit_NeoPixel::gamma32(const uint32_t x) {
+  return ((uint32_t)gamma8(x >> 24) << 24) | ((uint32_t)gamma8(x >> 16) << 16) |
+         ((uint32_t)gamma8(x >> 8) << 8) | gamma8(x);
+}
+
+/*
+ * same arithmetic as the Adafruit library
+ */
+uint32_t Adafruit_NeoPixel::ColorHSV(uint16_t hue, const uint8_t sat, const uint8_t val) {
+  uint8_t r, g, b;
+  hue = (hue * 1530L + 32768) / 65536;
+  if (hue < 510) {
+    b = 0;
+    if (hue < 255) { r = 255; g = hue; }
+    else { r = 510 - hue; g = 255; }
+  }
+  else if (hue < 1020) {
+    r = 0;
+    if (hue < 765) { g = 255; b = hue - 510; }
+    else { g = 1020 - hue; b = 255; }
+  }
+  else if (hue < 1530) {
+    g = 0;
+    if (hue < 1275) { r = hue - 1020; b = 255; }
+    else { r = 255; b = 1530 - hue; }
+  }
+  else {
+    r = 255;
+    g = b = 0;
+  }
+  uint32_t v1 = 1 + val;
+  uint16_t s1 = 1 + sat;
+  uint8_t s2 = 255 - sat;
+  return ((((((r * s1) >> 8) + s2) * v1) & 0xff00) << 8) |
+         (((((g * s1) >> 8) + s2) * v1) & 0xff00) |
+         (((((b * s1) >> 8) + s2) * v1) >> 8);
+}
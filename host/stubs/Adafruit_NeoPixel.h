@@ -0,0 +1,86 @@
+// NAME: Adafruit_NeoPixel.h
+//
+// DESC: Host version of the Adafruit_NeoPixel library with the same pixel buffer semantics:
+//       setPixelColor() stores colors scaled by the brightness in the color order of the
+//       strip, setBrightness() rescales the buffer, getPixelColor() scales back and show()
+//       transmits the buffer as it is.
+//
+//       Instead of driving a data pin, show() captures the transmitted bytes, see
+//       getShownPixels() and getShownColor(). Transmission takes no virtual time.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef ADAFRUIT_NEOPIXEL_H
+#define ADAFRUIT_NEOPIXEL_H
+
+#include <Arduino.h>
+
+// offsets of white, red, green and blue in a pixel like the Adafruit library
+#define NEO_RGB   ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_RBG   ((0 << 6) | (0 << 4) | (2 << 2) | (1))
+#define NEO_GRB   ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_GBR   ((2 << 6) | (2 << 4) | (0 << 2) | (1))
+#define NEO_BRG   ((1 << 6) | (1 << 4) | (2 << 2) | (0))
+#define NEO_BGR   ((2 << 6) | (2 << 4) | (1 << 2) | (0))
+#define NEO_RGBW  ((3 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_GRBW  ((3 << 6) | (1 << 4) | (0 << 2) | (2))
+
+#define NEO_KHZ800  0x0000
+#define NEO_KHZ400  0x0100
+
+typedef uint16_t neoPixelType;
+
+extern const uint8_t _NeoPixelGammaTable[256];
+
+class Adafruit_NeoPixel {
+private:
+  uint16_t  numLEDs;
+  uint8_t   brightness;       // brightness + 1, 0 is full brightness
+  uint8_t   *pixels;
+  uint8_t   *shownPixels;     // copy of pixels at the last show()
+  uint16_t  numBytes;
+  uint8_t   rOffset;
+  uint8_t   gOffset;
+  uint8_t   bOffset;
+  uint8_t   wOffset;          // == rOffset without white
+  uint32_t  showCount;
+
+  static uint32_t totalShowCount;
+
+public:
+  Adafruit_NeoPixel(const uint16_t n, const int16_t pin = 6, const neoPixelType type = NEO_GRB + NEO_KHZ800);
+  ~Adafruit_NeoPixel();
+
+  void begin() {}
+  void show();
+  bool canShow() { return true; }
+  void setPin(const int16_t pin) { (void)pin; }
+  void updateType(const neoPixelType type);
+
+  void setPixelColor(const uint16_t n, const uint32_t c);
+  void setPixelColor(const uint16_t n, const uint8_t r, const uint8_t g, const uint8_t b);
+  void fill(const uint32_t c = 0, uint16_t first = 0, uint16_t count = 0);
+  void setBrightness(const uint8_t b);
+  void clear() { memset(pixels, 0, numBytes); }
+
+  uint8_t *getPixels() const { return pixels; }
+  uint8_t getBrightness() const { return brightness - 1; }
+  uint16_t numPixels() const { return numLEDs; }
+  uint32_t getPixelColor(const uint16_t n) const;
+
+  static uint8_t gamma8(const uint8_t x) { return pgm_read_byte(&_NeoPixelGammaTable[x]); }
+  static uint32_t gamma32(const uint32_t x);
+  static uint32_t Color(const uint8_t r, const uint8_t g, const uint8_t b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+  static uint32_t ColorHSV(uint16_t hue, const uint8_t sat = 255, const uint8_t val = 255);
+
+  // host only: capture of show()
+  uint32_t getShowCount() const { return showCount; }
+  static uint32_t getTotalShowCount() { return totalShowCount; }    // of all instances
+  const uint8_t *getShownPixels() const { return shownPixels; }
+  uint32_t getShownColor(const uint16_t n) const;   // color of pixel n as transmitted, 0xRRGGBB
+};
+
+#endif /* ADAFRUIT_NEOPIXEL_H */
@@ -0,0 +1,151 @@
+// NAME: Arduino.cpp
+//
+// DESC: Arduino compatibility layer for host builds of the sketch sources.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <Arduino.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+static uint64_t virtualTime = 0;          // microseconds
+static uint32_t randomState = 1;
+static HostArduino::RandomFunction randomFunction = NULL;
+static HostArduino::AnalogFunction analogFunction = NULL;
+static FILE *serialOutput = stdout;
+
+HardwareSerial Serial;
+
+/*
+ * virtual clock
+ */
+uint32_t millis() {
+  return (uint32_t)(virtualTime / 1000);
+}
+
+uint32_t micros() {
+  return (uint32_t)virtualTime;
+}
+
+void delay(const uint32_t ms) {
+  virtualTime += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(const uint32_t us) {
+  virtualTime += us;
+}
+
+void yield() {
+  virtualTime += 10;
+}
+
+void HostArduino::setTime(const uint64_t us) {
+  virtualTime = us;
+}
+
+void HostArduino::advance(const uint32_t us) {
+  virtualTime += us;
+}
+
+uint64_t HostArduino::getTime() {
+  return virtualTime;
+}
+
+/*
+ * random numbers: linear congruential generator, reproducible on all hosts
+ */
+void randomSeed(const uint32_t seed) {
+  if (0 != seed) randomState = seed;
+}
+
+long random(const long howBig) {
+  return random(0, howBig);
+}
+
+long random(const long howSmall, const long howBig) {
+  if (NULL != randomFunction) return randomFunction(howSmall, howBig);
+  if (howSmall >= howBig) return howSmall;
+  randomState = randomState * 1103515245UL + 12345UL;
+  return howSmall + (long)((randomState >> 1) % (uint32_t)(howBig - howSmall));
+}
+
+void HostArduino::setRandomFunction(RandomFunction function) {
+  randomFunction = function;
+}
+
+/*
+ * pins
+ */
+int analogRead(const uint8_t pin) {
+  if (NULL != analogFunction) return analogFunction(pin);
+  return random(1024);
+}
+
+void HostArduino::setAnalogFunction(AnalogFunction function) {
+  analogFunction = function;
+}
+
+/*
+ * serial output
+ */
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  for (size_t i=0; i<size; i++) {
+    write(buffer[i]);
+  }
+  return size;
+}
+
+size_t Print::print(const char *string) {
+  return write((const uint8_t *)string, strlen(string));
+}
+
+size_t Print::print(const char c) {
+  return write((uint8_t)c);
+}
+
+size_t Print::print(const long value) {
+  char buffer[24];
+  snprintf(buffer, sizeof(buffer), "%ld", value);
+  return print(buffer);
+}
+
+size_t Print::print(const unsigned long value) {
+  char buffer[24];
+  snprintf(buffer, sizeof(buffer), "%lu", value);
+  return print(buffer);
+}
+
+size_t Print::print(const double value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.2f", value);  // 2 digits like Print::print(double) of Arduino
+  return print(buffer);
+}
+
+size_t HardwareSerial::write(const uint8_t c) {
+  if (NULL != serialOutput) fputc(c, serialOutput);
+  return 1;
+}
+
+void HardwareSerial::flush() {
+  if (NULL != serialOutput) fflush(serialOutput);
+}
+
+void HostArduino::setSerialOutput(FILE *file) {
+  serialOutput = file;
+}
+
+/*
+ * heap
+ */
+size_t HostArduino::getHeapInUse() {
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 33)))
+  return mallinfo2().uordblks;
+#elif defined(__GLIBC__)
+  return (size_t)(unsigned int)mallinfo().uordblks;
+#else
+  return 0;
+#endif
+}
@@ -0,0 +1,136 @@
+// NAME: Arduino.h
+//
+// DESC: Arduino compatibility layer for host builds of the sketch sources.
+//
+//       Provides the subset of the Arduino core used by the sketch: PROGMEM access, a virtual
+//       clock behind millis(), micros(), delay() and yield(), a reproducible random(),
+//       analogRead() and Serial, which writes to stdout. Tests and benchmarks control the
+//       virtual clock, random() and analogRead() through the functions in namespace HostArduino.
+//
+//       The clock only advances when told to, by delay(), delayMicroseconds() and yield()
+//       (10 microseconds, so busy waits for a timeout terminate) or HostArduino::advance().
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#ifdef ARDUINO
+#error Arduino.h of the host compatibility layer included by an Arduino build
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROGMEM
+#define pgm_read_byte(address)   (*(const uint8_t *)(address))
+#define pgm_read_word(address)   (*(const uint16_t *)(address))
+#define pgm_read_dword(address)  (*(const uint32_t *)(address))
+#define F(string)                (string)
+
+#define HIGH    1
+#define LOW     0
+#define INPUT   0
+#define OUTPUT  1
+
+typedef bool boolean;
+
+/*
+ * virtual clock
+ */
+uint32_t millis();
+uint32_t micros();
+void delay(const uint32_t ms);
+void delayMicroseconds(const uint32_t us);
+void yield();
+
+/*
+ * random numbers, reproducible on all hosts
+ */
+void randomSeed(const uint32_t seed);
+long random(const long howBig);
+long random(const long howSmall, const long howBig);
+
+/*
+ * pins
+ */
+inline void pinMode(const uint8_t pin, const uint8_t mode) { (void)pin; (void)mode; }
+inline void digitalWrite(const uint8_t pin, const uint8_t value) { (void)pin; (void)value; }
+int analogRead(const uint8_t pin);
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+template<class T> inline T min(const T a, const T b) { return (a < b) ? a : b; }
+template<class T> inline T max(const T a, const T b) { return (a > b) ? a : b; }
+
+/*
+ * serial output and input
+ */
+class Print {
+public:
+  virtual ~Print() {}
+
+  virtual size_t write(const uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  virtual int availableForWrite() { return 64; }
+  virtual void flush() {}
+
+  size_t print(const char *string);
+  size_t print(const char c);
+  size_t print(const long value);
+  size_t print(const unsigned long value);
+  size_t print(const int value)           { return print((long)value); }
+  size_t print(const unsigned int value)  { return print((unsigned long)value); }
+  size_t print(const double value);
+  size_t println()                        { return print('\n'); }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+class HardwareSerial : public Stream {
+public:
+  void begin(const unsigned long baudRate) { (void)baudRate; }
+  void end() {}
+  operator bool() { return true; }
+
+  virtual size_t write(const uint8_t c);
+  using Print::write;
+  virtual void flush();
+
+  virtual int available()  { return 0; }
+  virtual int read()       { return -1; }
+  virtual int peek()       { return -1; }
+};
+
+extern HardwareSerial Serial;
+
+/*
+ * control of the compatibility layer by tests and benchmarks
+ */
+namespace HostArduino {
+  typedef long (*RandomFunction)(const long howSmall, const long howBig);
+  typedef int (*AnalogFunction)(const uint8_t pin);
+
+  void setTime(const uint64_t us);                // set virtual clock to us microseconds
+  void advance(const uint32_t us);                // advance virtual clock by us microseconds
+  uint64_t getTime();                             // virtual clock in microseconds
+
+  void setRandomFunction(RandomFunction function);  // replaces random(), NULL restores it
+  void setAnalogFunction(AnalogFunction function);  // replaces analogRead(), NULL restores it
+
+  void setSerialOutput(FILE *file);               // NULL discards output of Serial
+
+  size_t getHeapInUse();                          // bytes allocated from the heap
+}
+
+#endif /* ARDUINO_H */
@@ -0,0 +1,30 @@
+// NAME: TrappmannRobotics.cpp
+//
+// DESC: Host version of the TrappmannRobotics library.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <TrappmannRobotics.h>
+
+const char *toHexString(const uint32_t value) {
+  static char buffer[9];
+  snprintf(buffer, sizeof(buffer), "%lx", (unsigned long)value);
+  return buffer;
+}
+
+const char *getBaseName(const char *path) {
+  const char *baseName = strrchr(path, '/');
+  return (NULL == baseName) ? path : baseName + 1;
+}
+
+const char *TrappmannRobotics::getUploadTimestamp() {
+  return __DATE__ " " __TIME__;
+}
+
+uint32_t TrappmannRobotics::getFreeMemory() {
+  static size_t heapAtStart = HostArduino::getHeapInUse();
+  size_t heapInUse = HostArduino::getHeapInUse();
+  size_t used = (heapInUse > heapAtStart) ? heapInUse - heapAtStart : 0;
+  return (used < HOST_SRAM_SIZE) ? HOST_SRAM_SIZE - used : 0;
+}
@@ -0,0 +1,38 @@
+// NAME: TrappmannRobotics.h
+//
+// DESC: Host version of the TrappmannRobotics library: streaming into Print, toHexString()
+//       and the memory functions used by the sketch.
+//
+//       getFreeMemory() reports the SRAM of an Arduino Mega (8192 bytes) less the heap the
+//       host program allocated since the first call, so the sketch's accounting of used
+//       memory works like on the board.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef TRAPPMANNROBOTICS_H
+#define TRAPPMANNROBOTICS_H
+
+#include <Arduino.h>
+
+#define LF '\n'
+
+template<class T> inline Print &operator <<(Print &out, T value) { out.print(value); return out; }
+
+#ifdef DEBUG
+#define SEROUT(msg) Serial << msg
+#else
+#define SEROUT(msg)
+#endif
+
+#define HOST_SRAM_SIZE 8192
+
+const char *toHexString(const uint32_t value);
+const char *getBaseName(const char *path);
+
+namespace TrappmannRobotics {
+  const char *getUploadTimestamp();
+  uint32_t getFreeMemory();
+}
+
+#endif /* TRAPPMANNROBOTICS_H */
@@ -0,0 +1,26 @@
+// NAME: LEDTest.h
+//
+// DESC: Minimal checks for the host tests: every test is a program, which returns the
+//       number of failed checks, see CHECK() and CHECK_EQUAL().
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#ifndef LEDTEST_H
+#define LEDTEST_H
+
+#include <stdio.h>
+
+static int testFailures = 0;
+
+#define CHECK(condition) \
+  do { if (!(condition)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); testFailures++; } } while (false)
+
+#define CHECK_EQUAL(expected, actual) \
+  do { long long e_ = (long long)(expected), a_ = (long long)(actual); \
+       if (e_ != a_) { printf("%s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); testFailures++; } } while (false)
+
+#define TEST_RESULT() \
+  (printf("%s\n", (0 == testFailures) ? "OK" : "FAILED"), testFailures)
+
+#endif /* LEDTEST_H */
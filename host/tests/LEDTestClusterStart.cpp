@@ -0,0 +1,62 @@
+// NAME: LEDTestClusterStart.cpp
+//
+// DESC: Test of the start of LEDClusters added by LEDClusterController::addCluster(): a
+//       cluster with a start time in the future begins to move at its start time, without
+//       catching up the update steps since it was added, and restarts every start interval.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDStripTest.h"
+#include "LEDClusterController.h"
+#include "LEDFrameBufferSink.h"
+
+#include "LEDTest.h"
+
+#define TEST_PIXELS     100
+#define TEST_INTERVAL   10L     // milliseconds per step
+#define TEST_START      1000L   // start time
+#define TEST_RESTART    5000L   // start interval
+
+static void runUntil(LEDClusterController &controller, const uint32_t time) {
+  while (millis() < time) {
+    controller.show();
+    delay(1);
+  }
+  controller.show();
+}
+
+int main() {
+  HostArduino::setSerialOutput(NULL);
+  HostArduino::setTime(0);
+  LEDFrameBufferSink strip(TEST_PIXELS);
+  LEDClusterController controller(strip, 4, 1024);
+  controller.begin();
+
+  LEDCluster *cluster = LEDCluster::initRGBPixel(COLOR_RED);
+  cluster->setDirection(LtR);
+  cluster->setUpdateInterval(TEST_INTERVAL);
+  cluster->setStartInterval(TEST_RESTART);
+  cluster->setStartTime(TEST_START);
+  controller.addCluster(cluster, 0);
+
+  runUntil(controller, TEST_START - 1);
+  CHECK_EQUAL(0, cluster->getPosition());
+  CHECK_EQUAL(0L, strip.getPixelColor(0));
+
+  // no burst of the steps between adding and starting
+  runUntil(controller, TEST_START);
+  CHECK_EQUAL(0, cluster->getPosition());
+  CHECK_EQUAL(COLOR_RED, strip.getPixelColor(0));
+  runUntil(controller, TEST_START + 5 * TEST_INTERVAL);
+  CHECK_EQUAL(5, cluster->getPosition());
+
+  // an active cluster added later starts updates when added
+  LEDCluster *later = LEDCluster::initRGBPixel(COLOR_BLUE);
+  later->setDirection(LtR);
+  later->setUpdateInterval(TEST_INTERVAL);
+  controller.addCluster(later, 50);
+  runUntil(controller, TEST_START + 8 * TEST_INTERVAL);
+  CHECK_EQUAL(53, later->getPosition());
+  return TEST_RESULT();
+}
@@ -0,0 +1,38 @@
+// NAME: LEDTestColor.cpp
+//
+// DESC: Test of gammaColorHSV() against gamma32(ColorHSV()) of the Adafruit library over all
+//       hues and saturations (and some values): equal without a table, within the error of
+//       the table steps with HSV_TABLE_STEPS 256 or 1536.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDColorError.h"
+
+#include "LEDTest.h"
+
+#if HSV_TABLE_STEPS == 0
+#define MAX_COLOR_ERROR   0
+#elif HSV_TABLE_STEPS == 256
+#define MAX_COLOR_ERROR   8
+#elif HSV_TABLE_STEPS == 1536
+#define MAX_COLOR_ERROR   3
+#endif
+
+int main() {
+  ColorError error = compareColorHSV(1, 1);
+  printf("HSV_TABLE_STEPS %u: max error %u, mean %.3f\n", HSV_TABLE_STEPS, error.maxError, (double)error.sumError / error.channels);
+  CHECK(error.maxError <= MAX_COLOR_ERROR);
+
+  error = compareColorHSV(64, 5, 5);
+  printf("HSV_TABLE_STEPS %u, darkened: max error %u, mean %.3f\n", HSV_TABLE_STEPS, error.maxError, (double)error.sumError / error.channels);
+  CHECK(error.maxError <= MAX_COLOR_ERROR);
+
+  // the primary colors of the color wheel are exact
+  CHECK_EQUAL(0xff0000L, gammaColorHSV(0));
+  CHECK_EQUAL(0x00ff00L, gammaColorHSV(65536L / 3));
+  CHECK_EQUAL(0x0000ffL, gammaColorHSV(65536L * 2 / 3));
+  CHECK_EQUAL(0xffffffL, gammaColorHSV(0, 0));
+  CHECK_EQUAL(0x000000L, gammaColorHSV(0, 255, 0));
+  return TEST_RESULT();
+}
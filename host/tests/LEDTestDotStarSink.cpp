@@ -0,0 +1,79 @@
+// NAME: LEDTestDotStarSink.cpp
+//
+// DESC: Test of LEDDotStarSink with the Adafruit_DotStar stub, which applies the brightness
+//       in show() like the library: the span path writePixels() must store the same unscaled
+//       colors as setPixelColor(), so the brightness is applied exactly once, and the power
+//       limit of LEDClusterController must settle at the brightness fitting the budget.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDStripTest.h"
+#include "LEDClusterController.h"
+#include "LEDDotStarSink.h"
+
+#include "LEDTest.h"
+
+#define TEST_PIXELS 100
+
+static void testWritePixels() {
+  LEDDotStarSink spanSink(TEST_PIXELS, DOTSTAR_BGR);
+  LEDDotStarSink pixelSink(TEST_PIXELS, DOTSTAR_BGR);
+  spanSink.setBrightness(127);
+  pixelSink.setBrightness(127);
+
+  uint8_t pixels[3 * TEST_PIXELS];
+  for (uint16_t i=0; i<sizeof(pixels); i++) pixels[i] = i * 7;
+  spanSink.writePixels(10, pixels, 80);
+  for (uint16_t pixelNo=0; pixelNo<80; pixelNo++) {
+    const uint8_t *pixel = pixels + 3 * pixelNo;
+    pixelSink.setPixelColor(10 + pixelNo, ((uint32_t)pixel[0] << 16) | ((uint32_t)pixel[1] << 8) | pixel[2]);
+  }
+  for (uint16_t pixelNo=0; pixelNo<TEST_PIXELS; pixelNo++) {
+    CHECK_EQUAL(pixelSink.getPixelColor(pixelNo), spanSink.getPixelColor(pixelNo));
+  }
+  CHECK_EQUAL(((uint32_t)pixels[0] << 16) | ((uint32_t)pixels[1] << 8) | pixels[2], spanSink.getPixelColor(10));
+  for (uint8_t channel=0; channel<3; channel++) {
+    CHECK_EQUAL(pixelSink.getIntensity(channel), spanSink.getIntensity(channel));
+  }
+}
+
+/*
+ * 300 white pixels need 300 * 45 mA at full brightness, a budget of 5000 mA leaves 4700 mA
+ * for the colors after 300 mA idle current: brightness 88, i.e. 89/256 of full current
+ */
+static void testPowerLimit() {
+  LEDDotStarSink strip(300, DOTSTAR_BGR);
+  LEDClusterController controller(strip, 4, 4096);
+  controller.setBrightness(255);
+  controller.setPowerBudget(5000);
+  HostArduino::setTime(0);
+  controller.begin();
+  controller.addCluster(LEDCluster::initRGBPixel(COLOR_WHITE, 299), 0);
+  LEDCluster *dot = LEDCluster::initRGBPixel(COLOR_RED);
+  dot->setDirection(LtR);
+  dot->setUpdateInterval(10);
+  dot->enableWrapAround();
+  controller.addCluster(dot, 299);  // damages the LED strip with every frame
+
+  uint8_t minBrightness = 255;
+  uint8_t maxBrightness = 0;
+  for (uint16_t frameNo=0; frameNo<200; frameNo++) {
+    delay(10);
+    controller.show();
+    CHECK(controller.estimateCurrent() <= 5000);
+    if (frameNo >= 100) {
+      if (strip.getBrightness() < minBrightness) minBrightness = strip.getBrightness();
+      if (strip.getBrightness() > maxBrightness) maxBrightness = strip.getBrightness();
+    }
+  }
+  CHECK(minBrightness >= 85);   // does not ratchet down
+  CHECK(maxBrightness <= 88);
+  CHECK(controller.estimateCurrent() > 4800);
+}
+
+int main() {
+  testWritePixels();
+  testPowerLimit();
+  return TEST_RESULT();
+}
@@ -0,0 +1,128 @@
+// NAME: LEDTestDoubleBufferSink.cpp
+//
+// DESC: Test of LEDDoubleBufferSink: with a front sink transmitting in the background,
+//       show() returns while the frame is clocked out, the next frame is rendered meanwhile
+//       and the next show() waits for the transmission (fence), so the front pixels never
+//       change during it. With dithered brightness, averaged over 256 frames every pixel
+//       shows its scaled color with the fraction, pixels without a fraction show the same
+//       value in every frame, and changed pixels reach the front sink.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDStripTest.h"
+#include "LEDDoubleBufferSink.h"
+#include "LEDFrameBufferSink.h"
+
+#include "LEDThreadSink.h"
+#include "LEDTest.h"
+
+#include <chrono>
+
+#define TEST_PIXELS     100
+#define TEST_BRIGHTNESS 99   // scale 100: 64 * 100 has no fraction, 1 * 100 has
+#define TEST_WIRE_PIXELS 600 // 18ms on the wire at 30us per pixel
+
+static uint32_t microsSince(const std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void testFence() {
+  LEDThreadSink front(TEST_WIRE_PIXELS);
+  LEDDoubleBufferSink buffer(front);
+  uint32_t wireMicros = front.getWireMicros();
+
+  // show() starts the transmission and returns
+  buffer.fill(0x102030, 0, TEST_WIRE_PIXELS);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  buffer.show();
+  uint32_t showMicros = microsSince(start);
+  CHECK(front.isBusy());
+  CHECK(showMicros < wireMicros / 4);
+
+  // the next frame is rendered into the back buffer meanwhile
+  buffer.fill(0x405060, 0, TEST_WIRE_PIXELS / 2);
+  CHECK(front.isBusy());
+  CHECK_EQUAL(0x102030, front.getPixelColor(0));
+
+  // and shown after the previous frame left
+  buffer.show();
+  uint32_t fenceMicros = microsSince(start);
+  CHECK_EQUAL(1, front.getFramesTransmitted());
+  CHECK(front.isBusy());
+  CHECK(fenceMicros >= wireMicros);
+  front.waitIdle();
+  printf("show() %u us, fenced show() after %u us, %u us on the wire\n", showMicros, fenceMicros, wireMicros);
+
+  CHECK_EQUAL(2, front.getFramesTransmitted());
+  CHECK_EQUAL(0, front.getTornFrames());
+  CHECK_EQUAL(0, front.getWritesWhileBusy());
+  CHECK_EQUAL(0x405060, front.getTransmittedColor(0));
+  CHECK_EQUAL(0x102030, front.getTransmittedColor(TEST_WIRE_PIXELS - 1));
+
+  // a write into the front sink without the fence is detected
+  front.show();
+  front.setPixelColor(0, 0L);
+  front.waitIdle();
+  CHECK_EQUAL(1, front.getWritesWhileBusy());
+}
+
+static void testDithering() {
+  LEDFrameBufferSink front(TEST_PIXELS);
+  front.setBrightness(TEST_BRIGHTNESS);
+  LEDDoubleBufferSink buffer(front);
+  buffer.setDithering(true);
+  CHECK_EQUAL(TEST_BRIGHTNESS, buffer.getBrightness());
+  CHECK_EQUAL(255, front.getBrightness());
+  CHECK(buffer.needsRefresh());
+
+  for (uint16_t pixelNo=0; pixelNo<TEST_PIXELS; pixelNo++) {
+    uint8_t value = pixelNo * 5 + 1;
+    buffer.setPixelColor(pixelNo, (pixelNo % 4) ? ((uint32_t)value << 16) | ((uint32_t)(255 - value) << 8) | (value / 2) : 0x404040);
+  }
+
+  uint32_t sums[TEST_PIXELS][3] = { { 0L } };
+  uint16_t unsteady = 0;
+  for (uint16_t frameNo=0; frameNo<256; frameNo++) {
+    buffer.show();
+    for (uint16_t pixelNo=0; pixelNo<TEST_PIXELS; pixelNo++) {
+      uint32_t color = front.getPixelColor(pixelNo);
+      sums[pixelNo][0] += (color >> 16) & 0xff;
+      sums[pixelNo][1] += (color >> 8) & 0xff;
+      sums[pixelNo][2] += color & 0xff;
+      if ((0 == pixelNo % 4) && (0x191919 != color)) unsteady++;   // 64 * 100 / 256 = 25
+    }
+  }
+  CHECK_EQUAL(0, unsteady);
+
+  // every pixel got all 256 thresholds once: the sum of the frames is the scaled color exactly
+  uint16_t errors = 0;
+  for (uint16_t pixelNo=0; pixelNo<TEST_PIXELS; pixelNo++) {
+    uint32_t color = buffer.getPixelColor(pixelNo);
+    for (uint8_t channel=0; channel<3; channel++) {
+      uint32_t scaled = ((color >> (16 - 8 * channel)) & 0xff) * (TEST_BRIGHTNESS + 1);
+      int32_t error = (int32_t)sums[pixelNo][channel] - (int32_t)scaled;
+      if (0 != error) {
+        if (errors++ < 5) printf("pixel %u channel %u: sum %u, expected %u\n", pixelNo, channel, sums[pixelNo][channel], scaled);
+      }
+    }
+  }
+  CHECK_EQUAL(0, errors);
+
+  // a steady pixel changed to black reaches the front sink
+  buffer.setPixelColor(4, 0L);
+  buffer.show();
+  CHECK_EQUAL(0L, front.getPixelColor(4));
+  CHECK_EQUAL(0x191919, front.getPixelColor(8));
+
+  // without dithering, the front sink applies the brightness again
+  buffer.setDithering(false);
+  CHECK_EQUAL(TEST_BRIGHTNESS, front.getBrightness());
+  CHECK(!buffer.needsRefresh());
+}
+
+int main() {
+  testFence();
+  testDithering();
+  return TEST_RESULT();
+}
@@ -0,0 +1,148 @@
+// NAME: LEDTestHostRenderer.cpp
+//
+// DESC: Smoke test of LEDHostRenderer: a virtual LED strip of many tiles composed by several
+//       threads must show the same pixels as LEDClusterController composing the same clusters
+//       into an LEDFrameBufferSink, frame by frame. The frames also go through an LEDFrameFile.
+//       Clusters longer than LONG_SPAN_LENGTH, like the strip-wide background, are composed
+//       from the list of long spans of LEDClusterController.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDStripTest.h"
+#include "LEDClusterController.h"
+#include "LEDFrameBufferSink.h"
+#include "LEDHostRenderer.h"
+#include "LEDFrameFile.h"
+
+#include "LEDTest.h"
+
+#define TEST_PIXELS     3000
+#define TEST_CLUSTERS   120
+#define TEST_TILE_SIZE  256   // 12 tiles
+#define TEST_THREADS    3
+#define TEST_FRAMES     1000
+#define TEST_INTERVAL   10    // milliseconds per frame
+
+/*
+ * cluster number clusterNo of all kinds, the same sequence for the same seed of random()
+ */
+static LEDCluster *createCluster(const uint16_t clusterNo) {
+  LEDCluster *cluster = NULL;
+  switch (clusterNo % 6) {
+    case 0:
+      cluster = LEDCluster::initRGBPixel(random(0x1000000L), 1 + random(20));
+      break;
+    case 1:
+      cluster = LEDCluster::initRGBRainbow(6 + random(30));
+      break;
+    case 2:
+      cluster = LEDCluster::initRGBPattern(random(0x1000000L), random(256));
+      break;
+    case 3:
+      cluster = LEDCluster::initPulsarPixel(random(0x10000L), 1 + random(8), 1 + random(5));
+      break;
+    case 4:
+      cluster = LEDCluster::initPixelSource(11 + random(20), random(0x10000L));
+      break;
+    case 5:
+      cluster = LEDCluster::initRGBPixel(random(0x1000000L), 3);
+      cluster->setVelocity(FIXED16(3.3) * (random(7) - 3));
+      break;
+  }
+  if (5 != clusterNo % 6) {
+    cluster->setDirection(random(2) ? LtR : RtL);
+    cluster->setUpdateInterval(5 + random(100));
+  }
+  switch (random(3)) {
+    case 0:
+      cluster->enableWrapAround();
+      break;
+    case 1:
+      cluster->enableBackAndForth();
+      break;
+    default:
+      cluster->setStartInterval(500 + random(1000));
+  }
+  cluster->setLayer(random(3));
+  cluster->setBlendMode((BlendMode)random(3));
+  return cluster;
+}
+
+/*
+ * dim background over the whole strip and a rainbow over a sixth of it below all other clusters
+ */
+static LEDCluster *createBackground(const uint8_t backgroundNo) {
+  LEDCluster *cluster = (0 == backgroundNo) ? LEDCluster::initRGBPixel(0x100810, TEST_PIXELS) : LEDCluster::initRGBRainbow(TEST_PIXELS / 6);
+  cluster->setLayer(0);
+  cluster->setBlendMode((0 == backgroundNo) ? BlendReplace : BlendAdd);
+  return cluster;
+}
+
+int main() {
+  HostArduino::setSerialOutput(NULL);
+  HostArduino::setTime(0);
+
+  LEDFrameBufferSink frameBuffer(TEST_PIXELS);
+  LEDClusterController controller(frameBuffer, 200, 60000);
+  controller.setBrightness(255);
+  controller.begin();
+  LEDHostRenderer renderer(TEST_PIXELS, TEST_TILE_SIZE, TEST_THREADS);
+
+  controller.addCluster(createBackground(0), 0);
+  controller.addCluster(createBackground(1), TEST_PIXELS / 3);
+  renderer.addCluster(createBackground(0), 0);
+  renderer.addCluster(createBackground(1), TEST_PIXELS / 3);
+  randomSeed(5);
+  for (uint16_t clusterNo=0; clusterNo<TEST_CLUSTERS; clusterNo++) {
+    int32_t position = random(TEST_PIXELS);
+    controller.addCluster(createCluster(clusterNo), position);
+  }
+  randomSeed(5);
+  for (uint16_t clusterNo=0; clusterNo<TEST_CLUSTERS; clusterNo++) {
+    int32_t position = random(TEST_PIXELS);
+    renderer.addCluster(createCluster(clusterNo), position);
+  }
+  CHECK_EQUAL(TEST_CLUSTERS + 2, controller.getNumClusters());
+  CHECK_EQUAL(TEST_CLUSTERS + 2, renderer.getNumClusters());
+
+  const char *path = "LEDTestHostRenderer.ledf";
+  LEDFrameFile frameFile;
+  CHECK(frameFile.create(path, TEST_PIXELS, TEST_INTERVAL));
+
+  uint32_t mismatches = 0;
+  uint32_t litPixels = 0;
+  for (uint16_t frameNo=0; frameNo<TEST_FRAMES; frameNo++) {
+    delay(TEST_INTERVAL);
+    controller.show();
+    renderer.advance(millis());
+    renderer.compose();
+    frameFile.writeFrame(renderer.getPixels());
+
+    CHECK_EQUAL(controller.getNumClusters(), renderer.getNumClusters());
+    for (uint16_t pixelNo=0; pixelNo<TEST_PIXELS; pixelNo++) {
+      if (0L != renderer.getPixelColor(pixelNo)) litPixels++;
+      if (frameBuffer.getPixelColor(pixelNo) != renderer.getPixelColor(pixelNo)) {
+        if (mismatches++ < 5) {
+          printf("frame %u pixel %u: controller %06x, renderer %06x\n", frameNo, pixelNo, frameBuffer.getPixelColor(pixelNo), renderer.getPixelColor(pixelNo));
+        }
+      }
+    }
+  }
+  CHECK_EQUAL(0, mismatches);
+  CHECK(litPixels > TEST_FRAMES * 100);
+  frameFile.close();
+
+  // last frame read back from the frame file
+  std::vector<uint32_t> pixels(TEST_PIXELS, 0L);
+  CHECK(frameFile.open(path));
+  uint16_t numFrames = 0;
+  while (frameFile.readFrame(pixels.data())) numFrames++;
+  frameFile.close();
+  remove(path);
+  CHECK_EQUAL(TEST_FRAMES, numFrames);
+  for (uint16_t pixelNo=0; pixelNo<TEST_PIXELS; pixelNo++) {
+    CHECK_EQUAL(renderer.getPixelColor(pixelNo), pixels[pixelNo]);
+  }
+  return TEST_RESULT();
+}
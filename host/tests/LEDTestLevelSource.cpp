@@ -0,0 +1,114 @@
+// NAME: LEDTestLevelSource.cpp
+//
+// DESC: Test of the level sources and LEDPeakMeter: a single sample spike between two
+//       updates of the peak meter must reach the bar, whether the source is polled at the
+//       sample rate (LEDAnalogLevel) or draws the samples due when read (LEDRandomLevel).
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDStripTest.h"
+#include "LEDLevelSource.h"
+#include "LEDPeakMeter.h"
+
+#include "LEDTest.h"
+
+#define TEST_UPDATE   20000L  // microseconds between updates of the peak meter
+#define TEST_SPIKE    7       // sample number of the spike
+#define TEST_LOW      100
+#define TEST_HIGH     LEVEL_MAX
+
+static uint32_t samples = 0;  // samples taken by the source
+
+static int analogSpike(uint8_t pin) {
+  return (TEST_SPIKE == samples++) ? TEST_HIGH : TEST_LOW;
+}
+
+static long randomSpike(long howSmall, long howBig) {
+  return (TEST_SPIKE == samples++) ? howBig - 1 : howSmall;
+}
+
+static void testAnalogLevel() {
+  HostArduino::setAnalogFunction(analogSpike);
+  HostArduino::setTime(0);
+  samples = 0;
+  LEDAnalogLevel source(0);
+
+  // polled at 1 kHz, read after 20 samples
+  for (uint32_t time=0; time<TEST_UPDATE; time+=LEVEL_SAMPLE_INTERVAL) {
+    HostArduino::setTime(time);
+    source.poll();
+  }
+  CHECK_EQUAL(TEST_UPDATE / LEVEL_SAMPLE_INTERVAL, samples);
+  uint16_t level = 0;
+  CHECK(source.readLevel(level));
+  CHECK_EQUAL(TEST_HIGH, level);
+  CHECK(!source.readLevel(level));  // no sample due
+
+  // the maximum is reset by the read
+  for (uint32_t time=TEST_UPDATE; time<2*TEST_UPDATE; time+=LEVEL_SAMPLE_INTERVAL) {
+    HostArduino::setTime(time);
+    source.poll();
+  }
+  CHECK(source.readLevel(level));
+  CHECK_EQUAL(TEST_LOW, level);
+  HostArduino::setAnalogFunction(NULL);
+}
+
+static void testRandomLevel() {
+  HostArduino::setRandomFunction(randomSpike);
+  HostArduino::setTime(0);
+  samples = 0;
+  LEDRandomLevel source(TEST_LOW, TEST_HIGH + 1);
+
+  // not polled: the samples due are drawn by the read
+  uint16_t level = 0;
+  CHECK(source.readLevel(level));
+  CHECK_EQUAL(TEST_LOW, level);
+  HostArduino::setTime(TEST_UPDATE);
+  CHECK(source.readLevel(level));
+  CHECK_EQUAL(1 + TEST_UPDATE / LEVEL_SAMPLE_INTERVAL, samples);
+  CHECK_EQUAL(TEST_HIGH, level);
+  CHECK(!source.readLevel(level));
+  HostArduino::setTime(2*TEST_UPDATE);
+  CHECK(source.readLevel(level));
+  CHECK_EQUAL(TEST_LOW, level);
+
+  // at most MAX_LEVEL_DRAWS after a long pause
+  samples = 0;
+  HostArduino::setTime(2*TEST_UPDATE + 1000*LEVEL_SAMPLE_INTERVAL);
+  CHECK(source.readLevel(level));
+  CHECK_EQUAL(MAX_LEVEL_DRAWS, samples);
+  HostArduino::setRandomFunction(NULL);
+}
+
+static void testPeakMeter() {
+  HostArduino::setAnalogFunction(analogSpike);
+  HostArduino::setTime(0);
+  samples = TEST_SPIKE + 1;
+  LEDAnalogLevel source(0);
+  LEDPeakMeter meter(20, 3);
+  meter.setLevelSource(&source);
+  meter.setPeakHold(10);
+  meter.setDecay(1);
+
+  meter.update(1);
+  CHECK_EQUAL((TEST_LOW + 1L) * 23 >> LEVEL_BITS, meter.getBarEnd());
+  samples = 0;
+  for (uint32_t time=LEVEL_SAMPLE_INTERVAL; time<=TEST_UPDATE; time+=LEVEL_SAMPLE_INTERVAL) {
+    HostArduino::setTime(time);
+    source.poll();
+  }
+  meter.update(1);
+  CHECK_EQUAL(23, meter.getBarEnd());
+  CHECK_EQUAL(23, meter.getPeakEnd());
+  HostArduino::setAnalogFunction(NULL);
+}
+
+int main() {
+  HostArduino::setSerialOutput(NULL);
+  testAnalogLevel();
+  testRandomLevel();
+  testPeakMeter();
+  return TEST_RESULT();
+}
@@ -0,0 +1,116 @@
+// NAME: LEDTestMultiChannelSink.cpp
+//
+// DESC: Test of the timing model of LEDMultiChannelSink with the WS2815 installation split
+//       into two channels: time on the wire of blocking channels (Adafruit_NeoPixel), which
+//       follow each other, for changes in one or both channels and with the LED strip driven
+//       by LEDClusterController, and of channels transmitting in the background
+//       (LEDThreadSink), whose overlap is measured.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDStripTest.h"
+#include "LEDClusterController.h"
+#include "LEDMultiChannelSink.h"
+#include "LEDNeoPixelSink.h"
+#include "LEDThreadSink.h"
+
+#include "LEDTest.h"
+
+#include <chrono>
+
+#define TEST_CHANNEL1   682
+#define TEST_CHANNEL2   354
+
+static uint32_t microsSince(const std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void testBackground() {
+  LEDThreadSink channel1(TEST_CHANNEL1);
+  LEDThreadSink channel2(TEST_CHANNEL2);
+  LEDPixelSink *channels[] = { &channel1, &channel2 };
+  LEDMultiChannelSink strip(channels, 2);
+
+  // both channels are started before show() returns and overlap on the wire
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  strip.show();
+  uint32_t showMicros = microsSince(start);
+  CHECK(channel1.isBusy() && channel2.isBusy());
+  strip.waitIdle();
+  uint32_t elapsedMicros = microsSince(start);
+  CHECK_EQUAL(channel1.getWireMicros(), strip.getWireMicros());
+  CHECK(elapsedMicros >= channel1.getWireMicros());
+  CHECK(elapsedMicros < channel1.getWireMicros() + channel2.getWireMicros() / 2);
+  printf("background channels: show() %u us, %u us until idle, %u us modeled\n", showMicros, elapsedMicros, strip.getWireMicros());
+
+  // a blocking channel started first delays the background channel
+  LEDNeoPixelSink blocking(TEST_CHANNEL1, DATA_PIN, NEO_GRB + NEO_KHZ800);
+  LEDPixelSink *mixed[] = { &blocking, &channel2 };
+  LEDMultiChannelSink mixedStrip(mixed, 2);
+  mixedStrip.show();
+  CHECK_EQUAL(blocking.getWireMicros() + channel2.getWireMicros(), mixedStrip.getWireMicros());
+  mixedStrip.waitIdle();
+  CHECK_EQUAL(0, channel1.getWritesWhileBusy() + channel2.getWritesWhileBusy());
+}
+
+int main() {
+  HostArduino::setSerialOutput(NULL);
+  HostArduino::setTime(0);
+
+  LEDNeoPixelSink channel1(TEST_CHANNEL1, DATA_PIN, NEO_GRB + NEO_KHZ800);
+  LEDNeoPixelSink channel2(TEST_CHANNEL2, DATA_PIN, NEO_GRB + NEO_KHZ800);
+  LEDPixelSink *channels[] = { &channel1, &channel2 };
+  LEDMultiChannelSink strip(channels, 2);
+
+  // 30us per RGB pixel at 800 kHz plus the latch
+  CHECK_EQUAL(TEST_CHANNEL1 * 30L + NEOPIXEL_LATCH_MICROS, channel1.getWireMicros());
+  CHECK_EQUAL(TEST_CHANNEL2 * 30L + NEOPIXEL_LATCH_MICROS, channel2.getWireMicros());
+  LEDNeoPixelSink slow(100, DATA_PIN, NEO_GRB + NEO_KHZ400);
+  CHECK_EQUAL(100 * 60L + NEOPIXEL_LATCH_MICROS, slow.getWireMicros());
+  LEDNeoPixelSink rgbw(100, DATA_PIN, NEO_GRBW + NEO_KHZ800);
+  CHECK_EQUAL(100 * 40L + NEOPIXEL_LATCH_MICROS, rgbw.getWireMicros());
+
+  // all channels are new
+  CHECK_EQUAL(0L, strip.getWireMicros());
+  strip.show();
+  CHECK_EQUAL(channel1.getWireMicros() + channel2.getWireMicros(), strip.getWireMicros());
+  printf("blocking channels: %u us\n", strip.getWireMicros());
+
+  // only the changed channel is transmitted
+  strip.setPixelColor(TEST_CHANNEL1 + 10, 0x102030);
+  strip.show();
+  CHECK_EQUAL(channel2.getWireMicros(), strip.getWireMicros());
+  strip.show();
+  CHECK_EQUAL(0L, strip.getWireMicros());
+  strip.fill(0x405060, TEST_CHANNEL1 - 5, 10);
+  strip.show();
+  CHECK_EQUAL(channel1.getWireMicros() + channel2.getWireMicros(), strip.getWireMicros());
+
+  // a cluster moving within the second channel: the first channel is transmitted once
+  LEDClusterController controller(strip, 4, 256);
+  controller.begin();
+  LEDCluster *cluster = LEDCluster::initRGBPixel(COLOR_RED, 3);
+  cluster->setDirection(LtR);
+  cluster->setUpdateInterval(20);
+  cluster->enableBackAndForth();
+  controller.addCluster(cluster, TEST_CHANNEL1 + 100);
+  uint32_t frames = 0, channelsShown = 0, wireMicros = 0;
+  while (millis() < 2000) {
+    uint32_t showCount = Adafruit_NeoPixel::getTotalShowCount();
+    controller.show();
+    if (Adafruit_NeoPixel::getTotalShowCount() != showCount) {
+      frames++;
+      channelsShown += Adafruit_NeoPixel::getTotalShowCount() - showCount;
+      wireMicros += strip.getWireMicros();
+    }
+    delay((controller.getIdleTime() > 0) ? controller.getIdleTime() : 1);
+  }
+  CHECK(frames > 50);
+  CHECK(channelsShown <= frames + 1);
+  CHECK(wireMicros <= frames * channel2.getWireMicros() + channel1.getWireMicros());
+  printf("moving cluster: %u frames, %u us per frame\n", frames, wireMicros / frames);
+
+  testBackground();
+  return TEST_RESULT();
+}
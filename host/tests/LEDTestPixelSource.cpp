@@ -0,0 +1,45 @@
+// NAME: LEDTestPixelSource.cpp
+//
+// DESC: Test of LEDPixelSource: the emitted pixels get darker with their distance from the
+//       center on both sides and fade out to black at the ends of the cluster, where the
+//       saturation alone would have left them almost white.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDStripTest.h"
+#include "LEDPixelSource.h"
+#include "LEDColor.h"
+
+#include "LEDTest.h"
+
+static uint8_t getMaxChannel(const uint32_t color) {
+  uint8_t red = color >> 16;
+  uint8_t green = color >> 8;
+  uint8_t blue = color;
+  uint8_t maxChannel = (red > green) ? red : green;
+  return (maxChannel > blue) ? maxChannel : blue;
+}
+
+static void testFading(const uint16_t length, const uint16_t hue) {
+  LEDPixelSource source(length, hue);
+  uint16_t center = length / 2;
+  source.update(center + 1);  // emitted up to both ends
+
+  CHECK_EQUAL(gammaColorHSV(hue), source.getColor(center));
+  for (uint16_t no=center; no>0; no--) {
+    CHECK(getMaxChannel(source.getColor(no-1)) <= getMaxChannel(source.getColor(no)));
+  }
+  for (uint16_t no=center; no+1<length; no++) {
+    CHECK(getMaxChannel(source.getColor(no+1)) <= getMaxChannel(source.getColor(no)));
+  }
+  CHECK(getMaxChannel(source.getColor(0)) <= 1);
+  CHECK(getMaxChannel(source.getColor(length-1)) <= 1);
+}
+
+int main() {
+  testFading(21, 0);
+  testFading(11, 40000);
+  testFading(100, 20000);
+  return TEST_RESULT();
+}
@@ -0,0 +1,254 @@
+// NAME: LEDTestScene.cpp
+//
+// DESC: Test of LEDClusterController::loadScene(): demoScene of LEDStripTest.ino and a scene
+//       with every record type and modifier are shown frame by frame like the same clusters
+//       built by hand, an unknown record stops loading without leaking the pending cluster,
+//       and a scene larger than the arena or the cluster slots loads as far as they reach.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDStripTest.ino"
+#include "LEDFrameBufferSink.h"
+
+#include "LEDTest.h"
+
+#include <vector>
+
+#define TEST_ARENA_SIZE   8192
+#define TEST_SECONDS      12    // beyond the restart of SCENE_START(0, 10000) in demoScene
+#define TEST_SEED         42
+
+typedef std::vector<std::vector<uint8_t> > Frames;
+typedef void (*AddClusters)(LEDClusterController &controller);
+
+/*
+ * every record type and modifier
+ */
+const uint8_t fullScene[] PROGMEM = {
+  SCENE_RGB_PIXEL(COLOR_YELLOW, 40, 10),
+    SCENE_LAYER(0, BlendReplace),
+  SCENE_RGB_RAINBOW(12, 30),
+    SCENE_MOVE(LtR, 40L),
+    SCENE_WRAP_AROUND,
+    SCENE_LAYER(2, BlendAdd),
+  SCENE_RGB_PATTERN(COLOR_CYAN, 0b10110011, 80),
+    SCENE_MOVE(RtL, 70L),
+    SCENE_BACK_AND_FORTH,
+  SCENE_PULSAR_PIXEL(20000, 3, 4, 120),
+    SCENE_START(1500L, 4000L),
+    SCENE_MOVE(LtR, 25L),
+  SCENE_PULSAR_RAINBOW(2, 16, 150),
+    SCENE_LAYER(1, BlendMax),
+  SCENE_PIXEL_SOURCE(15, 40000, 200),
+  SCENE_PEAK_METER(12, 4, 230),
+  SCENE_RGB_PIXEL(COLOR_MAGENTA, 3, 0),
+    SCENE_VELOCITY(FIXED16(12.5), FIXED16(4)),
+    SCENE_WRAP_AROUND,
+    SCENE_LAYER(3, BlendMax),
+  SCENE_END
+};
+
+static void addFullScene(LEDClusterController &controller) {
+  LEDCluster *cluster = LEDCluster::initRGBPixel(COLOR_YELLOW, 40);
+  cluster->setLayer(0);
+  cluster->setBlendMode(BlendReplace);
+  controller.addCluster(cluster, 10);
+
+  cluster = LEDCluster::initRGBRainbow(12);
+  cluster->setDirection(LtR);
+  cluster->setUpdateInterval(40L);
+  cluster->enableWrapAround();
+  cluster->setLayer(2);
+  cluster->setBlendMode(BlendAdd);
+  controller.addCluster(cluster, 30);
+
+  cluster = LEDCluster::initRGBPattern(COLOR_CYAN, 0b10110011);
+  cluster->setDirection(RtL);
+  cluster->setUpdateInterval(70L);
+  cluster->enableBackAndForth();
+  controller.addCluster(cluster, 80);
+
+  cluster = LEDCluster::initPulsarPixel(20000, 3, 4);
+  cluster->setStartInterval(4000L);
+  cluster->setStartTime(millis() + 1500L);
+  cluster->setDirection(LtR);
+  cluster->setUpdateInterval(25L);
+  controller.addCluster(cluster, 120);
+
+  cluster = LEDCluster::initPulsarRainbow(2, 16);
+  cluster->setLayer(1);
+  cluster->setBlendMode(BlendMax);
+  controller.addCluster(cluster, 150);
+
+  controller.addCluster(LEDCluster::initPixelSource(15, 40000), 200);
+  controller.addCluster(LEDCluster::initPeakMeter(12, 4), 230);
+
+  cluster = LEDCluster::initRGBPixel(COLOR_MAGENTA, 3);
+  cluster->setVelocity(FIXED16(12.5));
+  cluster->setAcceleration(FIXED16(4));
+  cluster->enableWrapAround();
+  cluster->setLayer(3);
+  cluster->setBlendMode(BlendMax);
+  controller.addCluster(cluster, 0);
+}
+
+static void addDemoScene(LEDClusterController &controller) {
+  controller.addCluster(LEDCluster::initRGBRainbow(6), (NUMPIXELS-6)/2);
+
+  LEDCluster *cluster = LEDCluster::initRGBPixel(COLOR_RED, 1);
+  cluster->setDirection(LtR);
+  cluster->setUpdateInterval(1000L);
+  cluster->enableBackAndForth();
+  controller.addCluster(cluster, 0);
+
+  cluster = LEDCluster::initRGBPixel(COLOR_BLUE, 5);
+  cluster->setDirection(RtL);
+  cluster->setUpdateInterval(0L);
+  cluster->enableWrapAround();
+  controller.addCluster(cluster, NUMPIXELS-1);
+
+  cluster = LEDCluster::initRGBPattern(COLOR_GREEN, 0b11010101);
+  cluster->setDirection(LtR);
+  cluster->setUpdateInterval(500L);
+  cluster->setStartInterval(10000L);
+  cluster->setStartTime(millis());
+  controller.addCluster(cluster, 0);
+
+  cluster = LEDCluster::initPulsarPixel(0, 1, 1);
+  cluster->setDirection(LtR);
+  cluster->setUpdateInterval(750L);
+  cluster->enableWrapAround();
+  controller.addCluster(cluster, 0);
+
+  cluster = LEDCluster::initPulsarPixel(0, 1, 3);
+  cluster->setDirection(RtL);
+  cluster->setUpdateInterval(300L);
+  cluster->enableWrapAround();
+  controller.addCluster(cluster, NUMPIXELS-1);
+
+  cluster = LEDCluster::initPeakMeter(20, 17);
+  cluster->setDirection(NoD);
+  cluster->setUpdateInterval(50L);
+  controller.addCluster(cluster, 0);
+
+  controller.addCluster(LEDCluster::initPixelSource(21, 0), 0);
+}
+
+/*
+ * frames of the clusters loaded from scene, or added by addClusters, if scene is NULL
+ */
+static Frames runFrames(const uint8_t *scene, AddClusters addClusters, uint16_t &numClusters) {
+  HostArduino::setTime(0);
+  randomSeed(TEST_SEED);
+  LEDFrameBufferSink strip(NUMPIXELS);
+  LEDClusterController controller(strip, 16, TEST_ARENA_SIZE);
+  controller.begin();
+  if (NULL != scene) {
+    CHECK_EQUAL(controller.getNumClusters(), 0);
+    numClusters = controller.loadScene(scene);
+    CHECK_EQUAL(numClusters, controller.getNumClusters());
+  }
+  else {
+    addClusters(controller);
+    numClusters = controller.getNumClusters();
+  }
+
+  Frames frames;
+  uint32_t showCount = strip.getShowCount();
+  while (millis() < TEST_SECONDS * 1000L) {
+    controller.show();
+    if (strip.getShowCount() != showCount) {
+      frames.push_back(std::vector<uint8_t>(strip.getPixels(), strip.getPixels() + 3 * NUMPIXELS));
+      showCount = strip.getShowCount();
+    }
+    uint32_t idleTime = controller.getIdleTime();
+    delay((idleTime > 0) ? idleTime : 1);
+  }
+  return frames;
+}
+
+static void compareScene(const char *name, const uint8_t *scene, AddClusters addClusters, const uint16_t expectedClusters) {
+  uint16_t sceneClusters = 0, builtClusters = 0;
+  Frames sceneFrames = runFrames(scene, NULL, sceneClusters);
+  Frames builtFrames = runFrames(NULL, addClusters, builtClusters);
+  CHECK_EQUAL(expectedClusters, sceneClusters);
+  CHECK_EQUAL(expectedClusters, builtClusters);
+  CHECK_EQUAL(builtFrames.size(), sceneFrames.size());
+  CHECK(sceneFrames.size() > 100);
+
+  uint32_t differentFrames = 0;
+  for (size_t frameNo=0; (frameNo<sceneFrames.size()) && (frameNo<builtFrames.size()); frameNo++) {
+    if (sceneFrames[frameNo] != builtFrames[frameNo]) {
+      if (0 == differentFrames++) printf("%s: frame %u differs\n", name, (unsigned)frameNo);
+    }
+  }
+  CHECK_EQUAL(0, differentFrames);
+  printf("%s: %u clusters, %u frames\n", name, sceneClusters, (unsigned)sceneFrames.size());
+}
+
+/*
+ * unknown records, the arena or the cluster slots running out
+ */
+static void testErrors() {
+  static const uint8_t unknownCluster[] PROGMEM = {
+    SCENE_RGB_PIXEL(COLOR_RED, 2, 0),
+    0x0f, SCENE_BYTES16(0),
+    SCENE_RGB_PIXEL(COLOR_GREEN, 2, 10),
+    SCENE_END
+  };
+  static const uint8_t unknownModifier[] PROGMEM = {
+    SCENE_RGB_PIXEL(COLOR_RED, 2, 0),
+    SCENE_RGB_RAINBOW(10, 10),
+      0x1f,
+    SCENE_RGB_PIXEL(COLOR_GREEN, 2, 30),
+    SCENE_END
+  };
+  static const uint8_t threeClusters[] PROGMEM = {
+    SCENE_RGB_RAINBOW(10, 0),
+    SCENE_RGB_RAINBOW(10, 20),
+      SCENE_MOVE(LtR, 10L),
+      SCENE_WRAP_AROUND,
+    SCENE_RGB_PIXEL(COLOR_GREEN, 2, 40),
+      SCENE_LAYER(1, BlendAdd),
+    SCENE_END
+  };
+  LEDFrameBufferSink strip(100);
+
+  // loading stops at the unknown record, the clusters before it are added
+  {
+    LEDClusterController controller(strip, 8, 1024);
+    CHECK_EQUAL(1, controller.loadScene(unknownCluster));
+    CHECK_EQUAL(1, controller.getNumClusters());
+  }
+  uint16_t pixelBytes = LEDClusterArena::getBlockSize(sizeof(LEDCluster)) + LEDClusterArena::getBlockSize(sizeof(PixelColor));
+  uint16_t rainbowBytes = LEDClusterArena::getBlockSize(sizeof(LEDCluster)) + LEDClusterArena::getBlockSize(10 * sizeof(PixelColor));
+  {
+    LEDClusterController controller(strip, 8, 1024);
+    CHECK_EQUAL(1, controller.loadScene(unknownModifier));
+    CHECK_EQUAL(1, controller.getNumClusters());
+    CHECK_EQUAL(pixelBytes, controller.getArena().getCapacity() - controller.getArena().getFreeBytes()); // rainbow released
+  }
+
+  // the arena runs out after the first cluster: the modifiers of the missing one are skipped
+  {
+    LEDClusterController controller(strip, 8, rainbowBytes + LEDClusterArena::getBlockSize(sizeof(LEDCluster)));
+    CHECK_EQUAL(1, controller.loadScene(threeClusters));
+    CHECK_EQUAL(1, controller.getNumClusters());
+  }
+  // the slots run out after two clusters: the third is released
+  {
+    LEDClusterController controller(strip, 2, 1024);
+    CHECK_EQUAL(2, controller.loadScene(threeClusters));
+    CHECK_EQUAL(2, controller.getNumClusters());
+    CHECK_EQUAL(2 * rainbowBytes, controller.getArena().getCapacity() - controller.getArena().getFreeBytes());
+  }
+}
+
+int main() {
+  HostArduino::setSerialOutput(NULL);
+  compareScene("fullScene", fullScene, addFullScene, 8);
+  compareScene("demoScene", demoScene, addDemoScene, 8);
+  testErrors();
+  return TEST_RESULT();
+}
@@ -0,0 +1,50 @@
+// NAME: LEDTestSketchArena.cpp
+//
+// DESC: Test of ARENASIZE of LEDStripTest.ino: setup() loads all ABSCHNITT segments of
+//       stripScene (and starts LEDStreamCluster with USE_SERIAL_INPUT), stripScene and
+//       demoScene need exactly the bytes estimated for them, and an arena of one byte less
+//       misses a segment. ARENASIZE is derived from sizeof() of the clusters, so this holds
+//       for the block sizes of AVR, too.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDStripTest.ino"
+#include "LEDFrameBufferSink.h"
+
+#include "LEDTest.h"
+
+static uint16_t loadScene(const uint8_t *scene, const uint16_t arenaSize, uint16_t &bytesUsed) {
+  LEDFrameBufferSink strip(NUMPIXELS);
+  LEDClusterController controller(strip, MAXCLUSTER, arenaSize);
+  controller.begin();
+  uint16_t numClusters = controller.loadScene(scene);
+  bytesUsed = controller.getArena().getHighWaterMark();
+  return numClusters;
+}
+
+int main() {
+  HostArduino::setSerialOutput(NULL);
+  printf("ARENASIZE %u: LEDCluster %u bytes in blocks of %u\n", (unsigned)ARENASIZE, (unsigned)sizeof(LEDCluster), LEDClusterArena::getBlockSize(sizeof(LEDCluster)));
+
+  // the sketch itself; first, as every controller makes its arena the arena of the clusters
+  setup();
+  CHECK_EQUAL(MAXCLUSTER, ledController.getNumClusters());
+  CHECK_EQUAL(ARENASIZE, ledController.getArena().getCapacity());
+  CHECK_EQUAL(ARENASIZE - SCENEBYTES + NUMSEGMENTS * SEGMENTBYTES, ledController.getArena().getHighWaterMark());
+
+  uint16_t bytesUsed = 0;
+  CHECK_EQUAL(NUMSEGMENTS, loadScene(stripScene, NUMSEGMENTS * SEGMENTBYTES, bytesUsed));
+  CHECK_EQUAL(NUMSEGMENTS * SEGMENTBYTES, bytesUsed);
+  CHECK_EQUAL(NUMSEGMENTS - 1, loadScene(stripScene, NUMSEGMENTS * SEGMENTBYTES - 1, bytesUsed));
+  CHECK_EQUAL(8, loadScene(demoScene, ARENASIZE, bytesUsed));
+  CHECK_EQUAL(DEMOBYTES, bytesUsed);
+  printf("stripScene %u bytes, demoScene %u bytes\n", (unsigned)(NUMSEGMENTS * SEGMENTBYTES), (unsigned)DEMOBYTES);
+
+  // block sizes
+  CHECK_EQUAL(ARENA_MIN_BLOCK_SIZE, LEDClusterArena::getBlockSize(0));
+  CHECK_EQUAL(ARENA_MIN_BLOCK_SIZE, LEDClusterArena::getBlockSize(3));
+  CHECK_EQUAL(64, LEDClusterArena::getBlockSize(64));
+  CHECK_EQUAL(128, LEDClusterArena::getBlockSize(65));
+  return TEST_RESULT();
+}
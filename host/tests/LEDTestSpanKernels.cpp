@@ -0,0 +1,101 @@
+// NAME: LEDTestSpanKernels.cpp
+//
+// DESC: Test of the kernels of LEDSpanKernels.h against scalar reference implementations
+//       for random spans, offsets, colors and color orders. host/CMakeLists.txt runs it for
+//       every build of the kernels (native, SSE2, SWAR, scalar).
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include "LEDSpanKernels.h"
+
+#include "LEDTest.h"
+
+#define TEST_SPAN     700   // longer than the widest vector loop, with tails of all lengths
+#define TEST_RUNS     3000
+
+static uint8_t blendChannel(const BlendMode mode, const uint8_t below, const uint8_t color) {
+  switch (mode) {
+    case BlendAdd:
+      return (below + color > 255) ? 255 : below + color;
+    case BlendMax:
+      return (below > color) ? below : color;
+    default:
+      return color;
+  }
+}
+
+int main() {
+  static const uint8_t colorOrders[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+  static uint8_t pixels[3 * TEST_SPAN + 16], expected[3 * TEST_SPAN + 16];
+  static uint8_t wire[3 * TEST_SPAN + 16], expectedWire[3 * TEST_SPAN + 16];
+  static uint32_t pixels32[TEST_SPAN + 8], expected32[TEST_SPAN + 8];
+
+  randomSeed(7);
+  for (uint16_t run=0; run<TEST_RUNS; run++) {
+    uint16_t offset = random(16);     // all alignments
+    uint16_t count = random(600);
+    uint32_t color = random(0x1000000L);
+    BlendMode mode = (BlendMode)random(3);
+    const uint8_t channels[3] = { (uint8_t)(color >> 16), (uint8_t)(color >> 8), (uint8_t)color };
+    for (uint16_t i=0; i<sizeof(pixels); i++) pixels[i] = expected[i] = random(256);
+
+    spanBlend(pixels + offset, mode, color, count);
+    for (uint16_t i=0; i<3*count; i++) {
+      expected[offset + i] = blendChannel(mode, expected[offset + i], channels[i % 3]);
+    }
+    CHECK(0 == memcmp(pixels, expected, sizeof(pixels)));
+
+    uint16_t scale = 1 + random(256);
+    spanScale(pixels + offset, scale, count);
+    for (uint16_t i=0; i<3*count; i++) {
+      expected[offset + i] = (expected[offset + i] * scale) >> 8;
+    }
+    CHECK(0 == memcmp(pixels, expected, sizeof(pixels)));
+
+    const uint8_t *order = colorOrders[random(6)];
+    memset(wire, 0x5a, sizeof(wire));
+    memset(expectedWire, 0x5a, sizeof(expectedWire));
+    spanSwizzle(wire + offset, pixels + offset, order[0], order[1], order[2], count);
+    for (uint16_t pixelNo=0; pixelNo<count; pixelNo++) {
+      for (uint8_t channel=0; channel<3; channel++) {
+        expectedWire[offset + 3 * pixelNo + order[channel]] = pixels[offset + 3 * pixelNo + channel];
+      }
+    }
+    CHECK(0 == memcmp(wire, expectedWire, sizeof(wire)));
+
+    uint32_t sums[3] = { 1L, 2L, 3L };
+    uint32_t expectedSums[3] = { 1L, 2L, 3L };
+    spanIntensity(pixels + offset, count, sums);
+    for (uint16_t i=0; i<3*count; i++) {
+      expectedSums[i % 3] += pixels[offset + i];
+    }
+    CHECK(0 == memcmp(sums, expectedSums, sizeof(sums)));
+
+    for (uint16_t i=0; i<TEST_SPAN+8; i++) pixels32[i] = expected32[i] = random(0x1000000L);
+    uint16_t offset32 = random(8);
+    spanBlend32(pixels32 + offset32, mode, color | 0x7f000000L, count);  // ignores the top byte
+    for (uint16_t i=0; i<count; i++) {
+      uint32_t below = expected32[offset32 + i];
+      expected32[offset32 + i] = ((uint32_t)blendChannel(mode, below >> 16, channels[0]) << 16) |
+                                 ((uint32_t)blendChannel(mode, below >> 8, channels[1]) << 8) |
+                                 blendChannel(mode, below, channels[2]);
+    }
+    CHECK(0 == memcmp(pixels32, expected32, sizeof(pixels32)));
+  }
+
+  // a long span must not overflow the partial sums of the vector loops
+  static uint8_t white[3 * 60000];
+  memset(white, 255, sizeof(white));
+  uint32_t sums[3] = { 0L, 0L, 0L };
+  spanIntensity(white, 60000, sums);
+  CHECK_EQUAL(255L * 60000, sums[0]);
+  CHECK_EQUAL(255L * 60000, sums[1]);
+  CHECK_EQUAL(255L * 60000, sums[2]);
+
+  spanFill(white, 0x102030, 5);
+  CHECK_EQUAL(0x10, white[12]);
+  CHECK_EQUAL(0x30, white[14]);
+  CHECK_EQUAL(0xff, white[15]);
+  return TEST_RESULT();
+}
@@ -0,0 +1,232 @@
+// NAME: LEDTestStreamInput.cpp
+//
+// DESC: Loopback test of LEDStreamInput: messages written into a pipe are received through a
+//       Stream like Serial and shown by LEDClusterController on an LEDFrameBufferSink.
+//       A frame failing the CRC check or timing out must leave the shown frame untouched,
+//       a short frame keeps the remaining pixels. Finally a writer thread streams frames of
+//       the whole strip to measure the host time of the parser per byte and the frames per
+//       second it could take.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "LEDStripTest.h"
+#include "LEDClusterController.h"
+#include "LEDColor.h"
+#include "LEDFrameBufferSink.h"
+#include "LEDStreamInput.h"
+
+#include "LEDTest.h"
+
+#define TEST_PIXELS     1036
+#define TEST_FRAMES     500   // frames streamed by the writer thread
+#define TEST_INTERVAL   20    // milliseconds per frame
+
+/*
+ * Stream reading from a pipe, buffered like the receive buffer of a HardwareSerial
+ */
+class PipeStream : public Stream {
+private:
+  int       fds[2];
+  uint8_t   buffer[4096];
+  uint16_t  head;
+  uint16_t  tail;
+
+  void fill() {
+    if (head < tail) return;
+    int pending = 0;
+    if ((0 != ioctl(fds[0], FIONREAD, &pending)) || (pending <= 0)) return;
+    ssize_t bytes = ::read(fds[0], buffer, (pending < (int)sizeof(buffer)) ? pending : sizeof(buffer));
+    head = 0;
+    tail = (bytes > 0) ? bytes : 0;
+  }
+
+public:
+  PipeStream() {
+    if (0 != pipe(fds)) fds[0] = fds[1] = -1;
+    head = tail = 0;
+  }
+  ~PipeStream() {
+    close(fds[0]);
+    if (fds[1] >= 0) close(fds[1]);
+  }
+
+  virtual int available() { fill(); return tail - head; }
+  virtual int read()      { fill(); return (head < tail) ? buffer[head++] : -1; }
+  virtual int peek()      { fill(); return (head < tail) ? buffer[head] : -1; }
+  virtual size_t write(const uint8_t c) { return write(&c, 1); }
+  virtual size_t write(const uint8_t *data, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+      ssize_t bytes = ::write(fds[1], data + written, size - written);
+      if (bytes <= 0) break;
+      written += bytes;
+    }
+    return written;
+  }
+};
+
+static uint16_t updateCRC(uint16_t crc, const uint8_t data) {
+  crc ^= (uint16_t)data << 8;
+  for (uint8_t bit=0; bit<8; bit++) {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+/*
+ * framed message, see LEDStreamInput.h
+ */
+static std::vector<uint8_t> message(const uint8_t type, const std::vector<uint8_t> &payload) {
+  std::vector<uint8_t> bytes;
+  bytes.push_back(STREAM_SYNC);
+  bytes.push_back(type);
+  bytes.push_back(payload.size() & 0xff);
+  bytes.push_back(payload.size() >> 8);
+  bytes.insert(bytes.end(), payload.begin(), payload.end());
+  uint16_t crc = 0xffff;
+  for (uint16_t i=1; i<bytes.size(); i++) crc = updateCRC(crc, bytes[i]);
+  bytes.push_back(crc & 0xff);
+  bytes.push_back(crc >> 8);
+  return bytes;
+}
+
+static uint32_t patternColor(const uint16_t pixelNo, const uint8_t seed) {
+  return ((uint32_t)(pixelNo * 7 + seed) & 0xff) << 16 | ((uint32_t)(pixelNo * 3 + seed * 5) & 0xff) << 8 | ((pixelNo + seed * 11) & 0xff);
+}
+
+static std::vector<uint8_t> fullFrame(const uint16_t numPixels, const uint8_t seed) {
+  std::vector<uint8_t> payload;
+  for (uint16_t pixelNo=0; pixelNo<numPixels; pixelNo++) {
+    uint32_t color = patternColor(pixelNo, seed);
+    payload.push_back(color >> 16);
+    payload.push_back(color >> 8);
+    payload.push_back(color);
+  }
+  return message(STREAM_FULL_FRAME, payload);
+}
+
+static void send(PipeStream &pipe, const std::vector<uint8_t> &bytes) {
+  pipe.write(bytes.data(), bytes.size());
+}
+
+/*
+ * poll the input and show the next frame
+ */
+static void showFrame(LEDClusterController &controller, LEDStreamInput &input, PipeStream &pipe) {
+  input.poll(pipe);
+  delay(TEST_INTERVAL);
+  controller.show();
+}
+
+/*
+ * pixels [first, end) shown with the colors of seed
+ */
+static uint16_t countPattern(LEDFrameBufferSink &frameBuffer, const uint16_t first, const uint16_t end, const uint8_t seed) {
+  uint16_t matches = 0;
+  for (uint16_t pixelNo=first; pixelNo<end; pixelNo++) {
+    if (frameBuffer.getPixelColor(pixelNo) == patternColor(pixelNo, seed)) matches++;
+  }
+  return matches;
+}
+
+int main() {
+  HostArduino::setSerialOutput(NULL);
+  HostArduino::setTime(0);
+
+  LEDFrameBufferSink frameBuffer(TEST_PIXELS);
+  LEDClusterController controller(frameBuffer, 4, 1024);
+  controller.setBrightness(255);
+  controller.begin();
+  LEDCluster *pixel = LEDCluster::initRGBPixel(COLOR_BLACK);
+  LEDClusterHandle pixelHandle = controller.addCluster(pixel, 0);
+  LEDStreamInput input(controller);
+  CHECK(input.begin(255, BlendReplace));
+  PipeStream pipe;
+
+  // full frame
+  send(pipe, fullFrame(TEST_PIXELS, 1));
+  showFrame(controller, input, pipe);
+  CHECK_EQUAL(1, input.getMessages());
+  CHECK_EQUAL(TEST_PIXELS, countPattern(frameBuffer, 0, TEST_PIXELS, 1));
+
+  // frame with CRC error, then a short frame: the dropped pixels must not show up with it
+  std::vector<uint8_t> corrupted = fullFrame(TEST_PIXELS, 2);
+  corrupted[corrupted.size() - 1] ^= 0x01;
+  send(pipe, corrupted);
+  showFrame(controller, input, pipe);
+  CHECK_EQUAL(1, input.getErrors());
+  CHECK_EQUAL(TEST_PIXELS, countPattern(frameBuffer, 0, TEST_PIXELS, 1));
+  send(pipe, fullFrame(100, 3));
+  showFrame(controller, input, pipe);
+  CHECK_EQUAL(2, input.getMessages());
+  CHECK_EQUAL(100, countPattern(frameBuffer, 0, 100, 3));
+  CHECK_EQUAL(TEST_PIXELS - 100, countPattern(frameBuffer, 100, TEST_PIXELS, 1));
+
+  // frame cut off by the host, the next frame is shown
+  std::vector<uint8_t> truncated = fullFrame(TEST_PIXELS, 4);
+  truncated.resize(truncated.size() / 2);
+  send(pipe, truncated);
+  showFrame(controller, input, pipe);
+  delay(STREAM_TIMEOUT);
+  send(pipe, fullFrame(50, 5));
+  showFrame(controller, input, pipe);
+  CHECK_EQUAL(2, input.getErrors());
+  CHECK_EQUAL(3, input.getMessages());
+  CHECK_EQUAL(50, countPattern(frameBuffer, 0, 50, 5));
+  CHECK_EQUAL(50, countPattern(frameBuffer, 50, 100, 3));
+  CHECK_EQUAL(TEST_PIXELS - 100, countPattern(frameBuffer, 100, TEST_PIXELS, 1));
+
+  // run-length encoded frame: 10 red, 255 green, 1 blue
+  std::vector<uint8_t> runs = { 10, 0xff, 0, 0,  255, 0, 0xff, 0,  1, 0, 0, 0xff };
+  send(pipe, message(STREAM_RLE_FRAME, runs));
+  showFrame(controller, input, pipe);
+  CHECK_EQUAL(4, input.getMessages());
+  CHECK_EQUAL(COLOR_RED, frameBuffer.getPixelColor(9));
+  CHECK_EQUAL(COLOR_GREEN, frameBuffer.getPixelColor(10));
+  CHECK_EQUAL(COLOR_GREEN, frameBuffer.getPixelColor(264));
+  CHECK_EQUAL(COLOR_BLUE, frameBuffer.getPixelColor(265));
+  CHECK_EQUAL(TEST_PIXELS - 266, countPattern(frameBuffer, 266, TEST_PIXELS, 1));
+
+  // cluster update, applied only with correct CRC
+  std::vector<uint8_t> update = { (uint8_t)pixelHandle, (uint8_t)(pixelHandle >> 8), (uint8_t)(pixelHandle >> 16), (uint8_t)(pixelHandle >> 24),
+                                  ParamColor, 0x56, 0x34, 0x12, 0x00 };
+  std::vector<uint8_t> badUpdate = message(STREAM_CLUSTER, update);
+  badUpdate[6] ^= 0x01;
+  send(pipe, badUpdate);
+  showFrame(controller, input, pipe);
+  CHECK_EQUAL(3, input.getErrors());
+  CHECK_EQUAL(COLOR_BLACK, pixel->getRGBPixel(0));
+  send(pipe, message(STREAM_CLUSTER, update));
+  showFrame(controller, input, pipe);
+  CHECK_EQUAL(5, input.getMessages());
+  CHECK_EQUAL(0x123456, pixel->getRGBPixel(0));
+
+  // throughput of full frames written by another thread
+  std::vector<uint8_t> frames[2] = { fullFrame(TEST_PIXELS, 6), fullFrame(TEST_PIXELS, 7) };
+  std::thread writer([&]{
+    for (uint16_t frameNo=0; frameNo<TEST_FRAMES; frameNo++) send(pipe, frames[frameNo & 1]);
+  });
+  uint32_t messages = input.getMessages();
+  std::chrono::steady_clock::duration pollTime = std::chrono::steady_clock::duration::zero();
+  while (input.getMessages() - messages < TEST_FRAMES) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    input.poll(pipe);
+    pollTime += std::chrono::steady_clock::now() - start;
+  }
+  writer.join();
+  controller.show();
+  CHECK_EQUAL(3, input.getErrors());
+  CHECK_EQUAL(TEST_PIXELS, countPattern(frameBuffer, 0, TEST_PIXELS, 7));
+
+  double ns = std::chrono::duration<double, std::nano>(pollTime).count();
+  printf("%u frames of %u bytes: %.2f ns/byte, %.0f frames/s\n", TEST_FRAMES, (unsigned)frames[0].size(),
+    ns / TEST_FRAMES / frames[0].size(), TEST_FRAMES * 1e9 / ns);
+  return TEST_RESULT();
+}
@@ -0,0 +1,83 @@
+// NAME: LEDTestStubs.cpp
+//
+// DESC: Test of the Arduino compatibility layer: virtual clock, random() and the pixel buffer
+//       semantics of the Adafruit_NeoPixel and Adafruit_DotStar stubs.
+//
+// Copyright (c) 2020-21 by Andreas Trappmann
+// All rights reserved.
+
+#include <Arduino.h>
+#include <Adafruit_DotStar.h>
+#include <Adafruit_NeoPixel.h>
+
+#include "LEDTest.h"
+
+static long fixedRandom(const long howSmall, const long howBig) {
+  return howBig - 1;
+}
+
+static void testClock() {
+  HostArduino::setTime(999);
+  CHECK_EQUAL(0, millis());
+  delay(2);
+  CHECK_EQUAL(2, millis());
+  CHECK_EQUAL(2999, micros());
+  HostArduino::advance(1);
+  CHECK_EQUAL(3, millis());
+}
+
+static void testRandom() {
+  randomSeed(7);
+  long first = random(1000);
+  randomSeed(7);
+  CHECK_EQUAL(first, random(1000));
+  for (uint16_t i=0; i<1000; i++) {
+    long value = random(10, 20);
+    CHECK((value >= 10) && (value < 20));
+  }
+  HostArduino::setRandomFunction(fixedRandom);
+  CHECK_EQUAL(19, random(10, 20));
+  HostArduino::setRandomFunction(NULL);
+}
+
+/*
+ * NeoPixel: scaled on setPixelColor(), transmitted as stored
+ */
+static void testNeoPixel() {
+  Adafruit_NeoPixel strip(4, 6, NEO_GRB + NEO_KHZ800);
+  strip.setBrightness(127);
+  strip.setPixelColor(1, 0x804020);
+  CHECK_EQUAL(0x20, strip.getPixels()[3]);    // green first, scaled
+  CHECK_EQUAL(0x40, strip.getPixels()[4]);
+  CHECK_EQUAL(0x10, strip.getPixels()[5]);
+  CHECK_EQUAL(0x804020, strip.getPixelColor(1));
+  strip.show();
+  CHECK_EQUAL(0x402010, strip.getShownColor(1));
+  CHECK_EQUAL(1, strip.getShowCount());
+}
+
+/*
+ * DotStar: stored unscaled, brightness applied by show()
+ */
+static void testDotStar() {
+  Adafruit_DotStar strip(4, DOTSTAR_BGR);
+  strip.setBrightness(127);
+  strip.setPixelColor(2, 0x804020);
+  CHECK_EQUAL(0x20, strip.getPixels()[6]);    // blue first, unscaled
+  CHECK_EQUAL(0x80, strip.getPixels()[8]);
+  CHECK_EQUAL(0x804020, strip.getPixelColor(2));
+  CHECK_EQUAL(127, strip.getBrightness());
+  strip.show();
+  CHECK_EQUAL(0x402010, strip.getShownColor(2));
+  strip.setBrightness(255);
+  strip.show();
+  CHECK_EQUAL(0x804020, strip.getShownColor(2));
+}
+
+int main() {
+  testClock();
+  testRandom();
+  testNeoPixel();
+  testDotStar();
+  return TEST_RESULT();
+}